@@ -0,0 +1,47 @@
+// Benchmark: hwinfo::getAllDisks() (previous status path) vs FilesystemCollector
+// Usage: bench_filesystems [iterations]
+
+#include "filesystem_stats.h"
+#include <hwinfo/disk.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+template <typename Fn>
+static double time_per_call_us(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+    if (iterations <= 0) iterations = 200;
+
+    size_t hwinfo_disks = 0;
+    double hwinfo_us = time_per_call_us(iterations, [&]() {
+        auto disks = hwinfo::getAllDisks();
+        hwinfo_disks = disks.size();
+    });
+
+    FilesystemCollector collector;
+    collector.collect();  // Initial mount table parse, as done once at startup
+    double statvfs_us = time_per_call_us(iterations, [&]() {
+        collector.collect();
+    });
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "iterations:                 " << iterations << std::endl;
+    std::cout << "hwinfo::getAllDisks():      " << hwinfo_us << " us/call (" << hwinfo_disks << " disks)" << std::endl;
+    std::cout << "FilesystemCollector:        " << statvfs_us << " us/call ("
+              << collector.filesystems().size() << " filesystems, "
+              << collector.mount_table_parses() << " mount table parses)" << std::endl;
+    if (statvfs_us > 0) {
+        std::cout << "speedup:                    " << hwinfo_us / statvfs_us << "x" << std::endl;
+    }
+    return 0;
+}
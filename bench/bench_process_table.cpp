@@ -0,0 +1,96 @@
+// Benchmark: open/read/close of every /proc/[pid]/stat plus a full sort
+// (what a naive top does) vs ProcessTableScanner
+// Usage: bench_process_table [iterations] [extra_processes]
+// HOST_PROC=<dir> runs both against a recorded /proc tree instead of the live one
+
+#include "process_stats.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+template <typename Fn>
+static double time_per_call_us(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+static size_t naive_top(size_t top_n) {
+    std::vector<ProcessEntry> rows;
+    DIR* dir = opendir(host_proc_root().c_str());
+    if (dir == nullptr) return 0;
+    char buf[1024];
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') continue;
+        std::string path = host_proc_root() + "/" + entry->d_name + "/stat";
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        ssize_t n = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+        if (n <= 0) continue;
+        buf[n] = '\0';
+        ProcPidStat stat;
+        if (!parse_proc_pid_stat(buf, stat)) continue;
+        ProcessEntry row;
+        row.pid = std::atoi(entry->d_name);
+        row.comm = stat.comm;
+        row.cpu_time_ticks = stat.utime_ticks + stat.stime_ticks;
+        rows.push_back(row);
+    }
+    closedir(dir);
+    std::sort(rows.begin(), rows.end(), [](const ProcessEntry& a, const ProcessEntry& b) {
+        return a.cpu_time_ticks > b.cpu_time_ticks;
+    });
+    return std::min(rows.size(), top_n);
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100;
+    if (iterations <= 0) iterations = 100;
+    int extra = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    // Idle children to bring the process count up to a realistic busy host
+    std::vector<pid_t> children;
+    for (int i = 0; i < extra; ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            pause();
+            _exit(0);
+        }
+        if (pid < 0) break;
+        children.push_back(pid);
+    }
+
+    const size_t top_n = 20;
+    double naive_us = time_per_call_us(iterations, [&]() { naive_top(top_n); });
+
+    ProcessTableScanner scanner;
+    scanner.scan(top_n, ProcessSortKey::Cpu);  // First scan opens every PID
+    double first_scan_us = scanner.last_scan_us();
+    double scanner_us = time_per_call_us(iterations, [&]() {
+        scanner.scan(top_n, ProcessSortKey::Cpu);
+    });
+
+    for (pid_t pid : children) kill(pid, SIGKILL);
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "iterations:                 " << iterations << std::endl;
+    std::cout << "processes:                  " << scanner.process_count() << std::endl;
+    std::cout << "naive open/read/close+sort: " << naive_us << " us/scan" << std::endl;
+    std::cout << "ProcessTableScanner:        " << scanner_us << " us/scan (first scan " << first_scan_us << " us)" << std::endl;
+    if (scanner_us > 0) {
+        std::cout << "speedup:                    " << naive_us / scanner_us << "x" << std::endl;
+    }
+    return 0;
+}
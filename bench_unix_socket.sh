@@ -0,0 +1,84 @@
+#!/bin/bash
+
+# Latency comparison: Unix domain socket vs TCP loopback
+# Run the server with both listeners, e.g. in config.json:
+#   "server": {"port": 8080, "host": "127.0.0.1", "unix_socket": "/run/metrics_monitor.sock"}
+
+PORT=${1:-8080}
+SOCKET_PATH=${2:-/run/metrics_monitor.sock}
+REQUESTS=${3:-2000}
+ENDPOINT=${4:-/health}
+
+echo "=========================================="
+echo "Benchmark ${ENDPOINT}: unix:${SOCKET_PATH} vs 127.0.0.1:${PORT}"
+echo "${REQUESTS} requests per mode"
+echo "=========================================="
+echo ""
+
+python3 - "$PORT" "$SOCKET_PATH" "$REQUESTS" "$ENDPOINT" <<'PYEOF'
+import http.client
+import socket
+import sys
+import time
+
+port = int(sys.argv[1])
+socket_path = sys.argv[2]
+requests = int(sys.argv[3])
+endpoint = sys.argv[4]
+
+
+class UnixHTTPConnection(http.client.HTTPConnection):
+    def __init__(self, path):
+        super().__init__("localhost")
+        self.path = path
+
+    def connect(self):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(self.path)
+
+
+def make_tcp():
+    conn = http.client.HTTPConnection("127.0.0.1", port)
+    conn.connect()
+    conn.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    return conn
+
+
+def make_unix():
+    return UnixHTTPConnection(socket_path)
+
+
+def run(factory, keep_alive):
+    samples = []
+    conn = factory() if keep_alive else None
+    for _ in range(requests):
+        start = time.perf_counter()
+        if not keep_alive:
+            conn = factory()
+        conn.request("GET", endpoint)
+        resp = conn.getresponse()
+        resp.read()
+        if not keep_alive:
+            conn.close()
+        samples.append((time.perf_counter() - start) * 1e6)
+    if keep_alive:
+        conn.close()
+    samples.sort()
+    return {
+        "mean": sum(samples) / len(samples),
+        "p50": samples[len(samples) // 2],
+        "p99": samples[min(len(samples) - 1, int(len(samples) * 0.99))],
+    }
+
+
+print("%-10s %-12s %10s %10s %10s" % ("transport", "connection", "mean_us", "p50_us", "p99_us"))
+for keep_alive in (True, False):
+    mode = "keep-alive" if keep_alive else "per-request"
+    for name, factory in (("tcp", make_tcp), ("unix", make_unix)):
+        try:
+            r = run(factory, keep_alive)
+        except OSError as e:
+            print("%-10s %-12s ✗ %s" % (name, mode, e))
+            continue
+        print("%-10s %-12s %10.1f %10.1f %10.1f" % (name, mode, r["mean"], r["p50"], r["p99"]))
+PYEOF
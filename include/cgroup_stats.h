@@ -0,0 +1,97 @@
+#ifndef CGROUP_STATS_H
+#define CGROUP_STATS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "proc_reader.h"
+
+/**
+ * Resource accounting of one cgroup v2 directory
+ * Rates are -1 until two consecutive samples are available
+ */
+struct CgroupStats {
+    std::string path;                 // Relative to the cgroup root, e.g. system.slice/vision.service
+    bool available = false;           // Directory exists and cpu.stat was read
+
+    // cpu.stat
+    unsigned long long cpu_usage_usec = 0;
+    unsigned long long cpu_user_usec = 0;
+    unsigned long long cpu_system_usec = 0;
+    unsigned long long nr_throttled = 0;
+    unsigned long long throttled_usec = 0;
+    double cpu_percent = -1;          // 100 = one full core
+    double throttled_percent = -1;    // Share of wall time spent throttled
+
+    // memory.current, memory.max ("max" reported as -1), memory.stat
+    long long memory_current_bytes = 0;
+    long long memory_max_bytes = -1;
+    long long memory_anon_bytes = 0;
+    long long memory_file_bytes = 0;
+    long long memory_kernel_bytes = 0;
+    unsigned long long pgmajfault = 0;
+
+    // io.stat, summed over devices
+    unsigned long long io_read_bytes = 0;
+    unsigned long long io_write_bytes = 0;
+    unsigned long long io_read_ios = 0;
+    unsigned long long io_write_ios = 0;
+    double io_read_bytes_per_sec = -1;
+    double io_write_bytes_per_sec = -1;
+    double io_read_iops = -1;
+    double io_write_iops = -1;
+
+    // pids.current
+    long long pids_current = 0;
+};
+
+/**
+ * Reads cpu.stat, memory.current/max/stat, io.stat and pids.current for a
+ * fixed set of cgroups. Each cgroup directory is opened once and its files
+ * are opened relative to it with openat() and then kept open, so a sample
+ * does no path resolution. A cgroup that disappears (unit restarted) is
+ * reopened by path on the next sample.
+ */
+class CgroupCollector {
+public:
+    explicit CgroupCollector(const std::vector<std::string>& paths,
+                             const std::string& cgroup_root = host_sys_root() + "/fs/cgroup");
+    ~CgroupCollector();
+
+    CgroupCollector(const CgroupCollector&) = delete;
+    CgroupCollector& operator=(const CgroupCollector&) = delete;
+
+    bool collect();
+
+    const std::vector<CgroupStats>& cgroups() const { return cgroups_; }
+
+private:
+    enum CgroupFile {
+        kCpuStat,
+        kMemoryCurrent,
+        kMemoryMax,
+        kMemoryStat,
+        kIoStat,
+        kPidsCurrent,
+        kCgroupFileCount
+    };
+
+    struct Handle {
+        int dir_fd = -1;
+        int fds[kCgroupFileCount];
+        bool has_previous = false;
+        std::chrono::steady_clock::time_point last_sample;
+    };
+
+    bool open_cgroup(size_t index);
+    void close_cgroup(size_t index);
+    bool read_file(int fd);
+
+    std::string cgroup_root_;
+    std::vector<CgroupStats> cgroups_;
+    std::vector<Handle> handles_;
+    std::vector<char> buffer_;
+    size_t size_;
+};
+
+#endif // CGROUP_STATS_H
@@ -0,0 +1,134 @@
+#ifndef COLLECTOR_REGISTRY_H
+#define COLLECTOR_REGISTRY_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * One source of status metrics (thermal, disks, ...) run by CollectorRegistry
+ * at its own interval; collect() refreshes the underlying readers and writes
+ * the collector's top-level status members, e.g. "  \"thermal\": {...}",
+ * without a trailing comma
+ */
+class StatusCollector {
+public:
+    StatusCollector(const std::string& name, int interval_ms)
+        : name_(name), interval_ms_(interval_ms), cpu_budget_percent_(-1) {}
+    virtual ~StatusCollector() {}
+
+    const std::string& name() const { return name_; }
+
+    /**
+     * Collection period; 0 collects once (static data such as topology)
+     */
+    int interval_ms() const { return interval_ms_; }
+    void set_interval_ms(int interval_ms) { interval_ms_ = interval_ms; }
+
+    /**
+     * CPU limit for this collector (percent of one core, 0 = none); negative
+     * uses the registry's cpu_budget_percent
+     */
+    double cpu_budget_percent() const { return cpu_budget_percent_; }
+    void set_cpu_budget_percent(double percent) { cpu_budget_percent_ = percent; }
+
+    virtual void collect(std::ostringstream& json) = 0;
+
+private:
+    std::string name_;
+    int interval_ms_;
+    double cpu_budget_percent_;
+};
+
+/**
+ * Scheduling and cost figures of one registered collector
+ */
+struct CollectorStats {
+    std::string name;
+    int interval_ms = 0;              // Configured
+    int effective_interval_ms = 0;    // After auto-slowing
+    double cpu_budget_percent = 0;    // The collector's own or the registry's, 0 = none
+    unsigned long long runs = 0;
+    double last_cpu_us = 0;           // Thread CPU time of the last collect()
+    double avg_cpu_us = 0;            // Exponentially weighted
+    double last_wall_us = 0;
+    double cpu_percent = 0;           // avg_cpu_us over the effective interval, percent of one core
+    long long age_ms = -1;            // Since the last collect(), -1 if never run
+};
+
+/**
+ * Runs StatusCollectors on a background thread, each at its own interval,
+ * and keeps the latest output of each as an immutable fragment
+ * A collector whose average CPU cost exceeds its CPU budget (its own
+ * cpu_budget_percent() if set, else the registry's, in percent of one core)
+ * at its current interval has the interval doubled (up to 64x the configured
+ * one), and halved again once it fits comfortably
+ * With idle back-off set, collectors run no more often than idle_interval_ms
+ * while nobody has called snapshot() for hold_ms; the first snapshot() after
+ * that refreshes overdue collectors inline and restores their intervals
+ */
+class CollectorRegistry {
+public:
+    explicit CollectorRegistry(double cpu_budget_percent);
+    ~CollectorRegistry();
+
+    CollectorRegistry(const CollectorRegistry&) = delete;
+    CollectorRegistry& operator=(const CollectorRegistry&) = delete;
+
+    /**
+     * Register a collector (before start()); status output follows registration order
+     */
+    void add(std::unique_ptr<StatusCollector> collector);
+
+    /**
+     * Slow every collector to at least idle_interval_ms once snapshot() has
+     * not been called for hold_ms (before start()); idle_interval_ms <= 0 disables
+     */
+    void set_idle_backoff(int hold_ms, int idle_interval_ms);
+
+    void start();
+    void stop();
+
+    /**
+     * Latest fragment of every collector in registration order; collectors
+     * that have not run yet (request before the first pass) are run inline,
+     * as are due collectors when start() was never called
+     */
+    std::vector<std::shared_ptr<const std::string>> snapshot();
+
+    std::vector<CollectorStats> stats() const;
+
+private:
+    struct Entry {
+        std::unique_ptr<StatusCollector> collector;
+        std::mutex collect_mutex;                 // Serializes collect() of this collector
+        mutable std::mutex fragment_mutex;        // Guards fragment and stats
+        std::shared_ptr<const std::string> fragment;
+        CollectorStats stats;
+        std::chrono::steady_clock::time_point last_run;
+        std::chrono::steady_clock::time_point next_due;
+    };
+
+    void run(Entry& entry);           // Caller holds entry.collect_mutex
+    bool is_idle(std::chrono::steady_clock::time_point now) const;
+    std::chrono::steady_clock::time_point idle_due(const Entry& entry, bool idle) const;
+    void loop();
+
+    std::vector<std::unique_ptr<Entry>> entries_;
+    double cpu_budget_percent_;
+    int idle_hold_ms_;
+    int idle_interval_ms_;
+    std::mutex thread_mutex_;                     // Guards thread_, stop_, wake_, last_demand_
+    std::condition_variable thread_cv_;
+    std::thread thread_;
+    bool stop_;
+    bool wake_;                                   // Re-plan the schedule (demand after idle)
+    std::chrono::steady_clock::time_point last_demand_;
+};
+
+#endif // COLLECTOR_REGISTRY_H
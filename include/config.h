@@ -2,10 +2,15 @@
 #define CONFIG_H
 
 #include <string>
+#include <utility>
+#include <vector>
 
 struct ServerConfig {
     int port;
-    std::string host;
+    std::string host;         // TCP listen address, empty to disable TCP
+    std::string unix_socket;  // AF_UNIX socket path, empty to disable
+    int unix_socket_mode;           // Permission bits for the socket file (octal in config.json)
+    std::string unix_socket_group;  // Group owning the socket file, empty to keep the server's group
 };
 
 struct AuthConfig {
@@ -22,11 +27,87 @@ struct LoggingConfig {
     std::string level;
 };
 
+struct SamplerConfig {
+    int interval_ms;                // Fastest sampling period: while metrics change or clients are active
+    int idle_interval_ms;           // Slowest period once metrics are stable; <= interval_ms samples at a fixed rate
+    int demand_hold_ms;             // How long one client request keeps its rate
+    double cpu_change_percent;      // CPU usage change between samples (points) that counts as volatile
+    double memory_change_percent;   // Change of available RAM, percent of total
+    double temperature_change_c;    // Change of any thermal zone
+    double psi_some_percent;        // cpu/memory/io "some" avg10 at or above this stays volatile
+};
+
+struct StatsdConfig {
+    bool enabled;
+    std::string host;
+    int port;
+    int interval_ms;       // Push period
+    std::string prefix;    // Metric name prefix, e.g. "metrics_monitor"
+    int max_packet_bytes;  // Upper bound for one UDP datagram payload
+};
+
+struct ShmConfig {
+    bool enabled;
+    std::string name;  // POSIX shm name, e.g. "/metrics_monitor"
+};
+
+struct DiskIoConfig {
+    bool include_partitions;  // Report partitions next to whole disks
+};
+
+struct PsiConfig {
+    std::vector<std::string> cgroups;   // cgroup v2 paths (relative) whose *.pressure files are reported
+    std::vector<std::string> triggers;  // "[cgroup:]<resource> <some|full> <stall_us> <window_us>"
+};
+
+struct CgroupStatsConfig {
+    std::vector<std::string> paths;     // cgroup v2 paths (relative), e.g. system.slice/vision.service
+};
+
+struct PerfConfig {
+    bool enabled;                       // perf_event_open counters (needs CAP_PERFMON or perf_event_paranoid <= 0)
+    bool system_wide;                   // Count everything on every CPU
+    std::vector<std::string> cgroups;   // cgroup v2 paths (relative) counted separately
+};
+
+struct HostPathsConfig {
+    std::string proc;                   // procfs root, e.g. /host/proc; empty = /proc (HOST_PROC takes precedence)
+    std::string sys;                    // sysfs root; empty = /sys (HOST_SYS)
+    std::string rootfs;                 // Host root filesystem for statvfs and /etc/machine-id; empty = / (HOST_ROOT)
+};
+
+struct CollectorsConfig {
+    double cpu_budget_percent;          // Per-collector CPU limit (percent of one core) before its interval is stretched, 0 = none
+    std::vector<std::pair<std::string, int>> intervals_ms;  // Collector name -> interval, overriding the built-in one
+    std::vector<std::pair<std::string, double>> cpu_budgets_percent;  // Collector name -> CPU limit, overriding cpu_budget_percent
+};
+
+/**
+ * How a registered instance is mapped to its processes; the first non-empty
+ * field wins (pidfile, then cgroup, then cmdline)
+ */
+struct InstanceBinding {
+    std::string id;                     // Instance id as listed in device_registered.json
+    std::string pidfile;                // File containing the main PID
+    std::string cgroup;                 // cgroup v2 path (relative); all PIDs in cgroup.procs
+    std::string cmdline;                // Substring matched against /proc/[pid]/cmdline
+};
+
 struct AppConfig {
     ServerConfig server;
     AuthConfig authentication;
     DeviceConfigPaths device;
     LoggingConfig logging;
+    SamplerConfig sampler;
+    StatsdConfig statsd;
+    ShmConfig shm;
+    DiskIoConfig disk_io;
+    PsiConfig psi;
+    CgroupStatsConfig cgroup_stats;
+    PerfConfig perf;
+    CollectorsConfig collectors;
+    HostPathsConfig host_paths;
+    std::vector<InstanceBinding> instance_bindings;
 };
 
 /**
@@ -0,0 +1,78 @@
+#ifndef CPUFREQ_STATS_H
+#define CPUFREQ_STATS_H
+
+#include <string>
+#include <vector>
+#include "proc_reader.h"
+
+/**
+ * One cpufreq policy: a set of CPUs sharing a clock (a cluster on big.LITTLE)
+ */
+struct CpuFreqPolicy {
+    std::string name;                 // policyN
+    std::vector<int> cpus;            // related_cpus
+    long long cur_khz = 0;
+    long long cpuinfo_min_khz = 0;    // Hardware limits, static
+    long long cpuinfo_max_khz = 0;
+    // Settings snapshot, re-parsed only when the sysfs contents change
+    std::string governor;
+    long long scaling_min_khz = 0;
+    long long scaling_max_khz = 0;
+};
+
+/**
+ * Current frequency of one logical CPU
+ */
+struct CpuCoreFreq {
+    int cpu = 0;
+    int policy = -1;                  // Index into policies(), -1 if none
+    long long cur_khz = 0;
+};
+
+/**
+ * Per-policy and per-core CPU frequency from persistent cpufreq file descriptors
+ * Each pass costs one pread of scaling_cur_freq per policy plus a byte compare
+ * of the governor/min/max files
+ */
+class CpuFreqCollector {
+public:
+    explicit CpuFreqCollector(const std::string& sys_root = host_sys_root());
+    ~CpuFreqCollector();
+
+    CpuFreqCollector(const CpuFreqCollector&) = delete;
+    CpuFreqCollector& operator=(const CpuFreqCollector&) = delete;
+
+    bool collect();
+
+    const std::vector<CpuFreqPolicy>& policies() const { return policies_; }
+    const std::vector<CpuCoreFreq>& cores() const { return cores_; }
+
+    /**
+     * Incremented whenever a governor or scaling limit changes
+     */
+    unsigned long settings_generation() const { return settings_generation_; }
+
+private:
+    // Cached raw contents of a settings attribute, compared byte-wise each pass
+    struct SettingFile {
+        int fd = -1;
+        std::string raw;
+    };
+
+    bool refresh_setting(SettingFile& file);
+
+    std::vector<CpuFreqPolicy> policies_;
+    std::vector<int> cur_fds_;
+    std::vector<SettingFile> governor_files_;
+    std::vector<SettingFile> min_files_;
+    std::vector<SettingFile> max_files_;
+    std::vector<CpuCoreFreq> cores_;
+    unsigned long settings_generation_;
+};
+
+/**
+ * Parse a cpulist such as "0-3,6" into CPU numbers
+ */
+std::vector<int> parse_cpu_list(const std::string& list);
+
+#endif // CPUFREQ_STATS_H
@@ -1,8 +1,10 @@
 #ifndef DEVICE_CONFIG_H
 #define DEVICE_CONFIG_H
 
+#include <memory>
 #include <string>
 #include <vector>
+#include "instance_set.h"
 
 struct DeviceInfo {
     std::string version;
@@ -23,6 +25,17 @@ struct DeviceInfo {
     std::string endpoint_port;  // Added for registration
 };
 
+/**
+ * Device information and instances as one immutable snapshot
+ * A published state is never modified; writers copy it, apply their change
+ * and publish the copy, so readers need no locks and see both parts consistently
+ */
+struct DeviceState {
+    DeviceInfo info;
+    InstanceSet instances;            // Registration order
+    bool default_instances = false;   // instances came from DEVICE_INSTANCES or the system UUID, not the file
+};
+
 struct DeviceStatus {
     long long uptime_seconds;
     bool detector_configured;
@@ -39,7 +52,15 @@ void load_device_config();
 void reload_device_config();
 
 /**
- * Get device information
+ * Current device state (loaded on first use); the reference stays valid and
+ * unchanged for as long as the caller holds it, across reloads and POSTs.
+ * Lock-free while the state is unchanged: each thread caches the snapshot it
+ * last loaded and takes the shared_ptr lock only once after each publish
+ */
+std::shared_ptr<const DeviceState> get_device_state();
+
+/**
+ * Get device information (a copy; prefer get_device_state() on hot paths)
  */
 DeviceInfo get_device_info();
 
@@ -49,15 +70,37 @@ DeviceInfo get_device_info();
 DeviceStatus get_device_status();
 
 /**
- * Get device instances
+ * Get device instances (a copy; prefer get_device_state() on hot paths)
  */
 std::vector<std::string> get_device_instances();
 
 /**
- * Set device instances
+ * Set device instances (publishes a new state)
  */
 void set_device_instances(const std::vector<std::string>& instances);
 
+/**
+ * Instance ids accepted by add_device_instance(): 1-256 characters, no
+ * control characters, quotes or backslashes
+ */
+bool is_valid_instance_id(const std::string& id);
+
+/**
+ * Register one instance without rewriting the device document: the change is
+ * appended to device_instances.journal (next to device_registered.json) and made
+ * durable before it is published; the journal is compacted into
+ * device_registered.json once it outgrows the instance list
+ * @param added false if the instance was already registered (nothing written)
+ * @return false if the change could not be persisted
+ */
+bool add_device_instance(const std::string& id, bool& added);
+
+/**
+ * Unregister one instance; see add_device_instance()
+ * @param removed false if the instance was not registered
+ */
+bool remove_device_instance(const std::string& id, bool& removed);
+
 /**
  * Read system UUID from Linux system
  */
@@ -75,7 +118,11 @@ std::string get_build_date();
 bool update_device_config_from_json(const std::string& json_str);
 
 /**
- * Save device configuration to file
+ * Save device configuration to file, replacing it atomically (temp file,
+ * fsync, rename, directory fsync)
+ * Calls arriving within a short window are coalesced into one write of the
+ * latest state; every caller blocks until a write covering its update is durable
+ * @return false if that write failed
  */
 bool save_device_config();
 
@@ -84,5 +131,18 @@ bool save_device_config();
  */
 std::string get_endpoint_port();
 
+/**
+ * Watch the directories of ./device_registered.json and /etc/device_registered.json
+ * with inotify and reload the configuration once per change to the file, so that
+ * requests read the cached configuration without touching the filesystem
+ * @return false if inotify is unavailable or neither directory could be watched
+ */
+bool start_device_config_watcher();
+
+/**
+ * Stop the watcher thread and close its descriptors
+ */
+void stop_device_config_watcher();
+
 #endif // DEVICE_CONFIG_H
 
@@ -0,0 +1,70 @@
+#ifndef DISK_IO_STATS_H
+#define DISK_IO_STATS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include "proc_reader.h"
+
+/**
+ * Per-block-device I/O rates derived from /proc/diskstats deltas
+ */
+struct DiskIoStats {
+    std::string name;
+    bool present = false;              // Seen in the latest pass
+    bool is_partition = false;
+    unsigned long long reads_completed = 0;
+    unsigned long long writes_completed = 0;
+    unsigned long long sectors_read = 0;
+    unsigned long long sectors_written = 0;
+    unsigned long long read_time_ms = 0;
+    unsigned long long write_time_ms = 0;
+    unsigned long long io_time_ms = 0;
+    unsigned long long ios_in_progress = 0;
+    double reads_per_sec = -1;         // -1 until two samples exist
+    double writes_per_sec = -1;
+    double read_bytes_per_sec = -1;
+    double write_bytes_per_sec = -1;
+    double read_await_ms = -1;         // Average time per completed read
+    double write_await_ms = -1;        // Average time per completed write
+    double await_ms = -1;              // Average over reads and writes
+    double util_percent = -1;          // Share of wall time the device was busy
+};
+
+/**
+ * Single-pass /proc/diskstats parser with a cached device-name -> slot index
+ */
+class DiskIoCollector {
+public:
+    explicit DiskIoCollector(bool include_partitions = false,
+                             const std::string& diskstats_path = host_proc_root() + "/diskstats",
+                             const std::string& sys_block_path = host_sys_root() + "/class/block");
+
+    /**
+     * Re-read /proc/diskstats and update counters and rates in place
+     */
+    bool collect();
+
+    /**
+     * All slots ever seen; filtered devices are never added
+     */
+    const std::vector<DiskIoStats>& devices() const { return slots_; }
+
+private:
+    // Returns -1 for devices excluded by the filter (cached as well)
+    long slot_for(const char* name, size_t len, size_t line_index);
+
+    bool include_partitions_;
+    std::string sys_block_path_;
+    ProcFileReader reader_;
+    std::vector<DiskIoStats> slots_;
+    std::unordered_map<std::string, long> index_;  // Device name -> slot or -1
+    std::vector<long> line_slots_;                 // Slot matched by each line last pass
+    std::vector<std::string> line_names_;
+    std::vector<char> previous_present_;
+    std::chrono::steady_clock::time_point last_time_;
+    bool has_previous_;
+};
+
+#endif // DISK_IO_STATS_H
@@ -0,0 +1,71 @@
+#ifndef FILESYSTEM_STATS_H
+#define FILESYSTEM_STATS_H
+
+#include <string>
+#include <vector>
+#include "proc_reader.h"
+
+/**
+ * Capacity and inode usage of one mounted filesystem (from statvfs)
+ */
+struct FilesystemStats {
+    std::string device;          // Mount source, e.g. /dev/nvme0n1p2
+    std::string model;           // Model of the disk holding it (sysfs device/model), empty if not a disk
+    std::string mount_point;
+    std::string fs_type;
+    unsigned long long total_bytes = 0;
+    unsigned long long free_bytes = 0;       // Free for root
+    unsigned long long available_bytes = 0;  // Free for unprivileged users
+    unsigned long long used_bytes = 0;
+    unsigned long long inodes_total = 0;
+    unsigned long long inodes_free = 0;
+    bool ok = false;                         // statvfs succeeded this pass
+};
+
+/**
+ * Mount table to report: /proc/self/mountinfo, or init's (<proc root>/1/mountinfo)
+ * when procfs is the host's mounted into a container
+ */
+std::string host_mountinfo_path();
+
+/**
+ * Mount-table driven filesystem usage collector
+ * /proc/self/mountinfo is parsed once and re-parsed only after the kernel
+ * signals a mount table change (POLLPRI); each pass is one statvfs per mount
+ */
+class FilesystemCollector {
+public:
+    /**
+     * @param rootfs prefix under which the mount points are reachable for statvfs
+     * @param sys_root sysfs root used to look up the disk model of each mount
+     */
+    explicit FilesystemCollector(const std::string& mountinfo_path = host_mountinfo_path(),
+                                 const std::string& rootfs = host_rootfs(),
+                                 const std::string& sys_root = host_sys_root());
+
+    /**
+     * Refresh usage for all real filesystems
+     */
+    bool collect();
+
+    const std::vector<FilesystemStats>& filesystems() const { return filesystems_; }
+
+    /**
+     * Number of times the mount table has been parsed (for diagnostics)
+     */
+    unsigned long mount_table_parses() const { return parses_; }
+
+private:
+    bool mount_table_changed();
+    void parse_mount_table();
+
+    ProcFileReader reader_;
+    std::string rootfs_;
+    std::string sys_root_;
+    std::vector<FilesystemStats> filesystems_;
+    std::vector<std::string> statvfs_paths_;  // rootfs_ + mount_point, parallel to filesystems_
+    bool parsed_;
+    unsigned long parses_;
+};
+
+#endif // FILESYSTEM_STATS_H
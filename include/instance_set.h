@@ -0,0 +1,77 @@
+#ifndef INSTANCE_SET_H
+#define INSTANCE_SET_H
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Set of instance ids with O(1) insert, erase and lookup that iterates in
+ * insertion order, so /info and device_registered.json list instances in
+ * the order they were registered
+ * Erased ids leave a tombstone slot; slots are compacted once tombstones
+ * outnumber live ids. Copies are plain vector/map copies (no internal pointers)
+ */
+class InstanceSet {
+public:
+    InstanceSet() {}
+    explicit InstanceSet(const std::vector<std::string>& ids);
+
+    /**
+     * @return false if id was already present (its position is kept)
+     */
+    bool insert(const std::string& id);
+
+    /**
+     * @return false if id was not present
+     */
+    bool erase(const std::string& id);
+
+    bool contains(const std::string& id) const { return index_.count(id) != 0; }
+    size_t size() const { return index_.size(); }
+    bool empty() const { return index_.empty(); }
+
+    std::vector<std::string> to_vector() const;
+
+    /**
+     * Forward iterator over live ids in insertion order
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string*;
+        using reference = const std::string&;
+
+        const_iterator(const std::vector<std::string>* slots, const std::vector<bool>* live, size_t pos)
+            : slots_(slots), live_(live), pos_(pos) { skip_dead(); }
+
+        reference operator*() const { return (*slots_)[pos_]; }
+        pointer operator->() const { return &(*slots_)[pos_]; }
+        const_iterator& operator++() { ++pos_; skip_dead(); return *this; }
+        bool operator==(const const_iterator& other) const { return pos_ == other.pos_; }
+        bool operator!=(const const_iterator& other) const { return pos_ != other.pos_; }
+
+    private:
+        void skip_dead() { while (pos_ < slots_->size() && !(*live_)[pos_]) ++pos_; }
+
+        const std::vector<std::string>* slots_;
+        const std::vector<bool>* live_;
+        size_t pos_;
+    };
+
+    const_iterator begin() const { return const_iterator(&slots_, &live_, 0); }
+    const_iterator end() const { return const_iterator(&slots_, &live_, slots_.size()); }
+
+private:
+    void compact();
+
+    std::vector<std::string> slots_;                  // Insertion order, including tombstones
+    std::vector<bool> live_;                          // Parallel to slots_
+    std::unordered_map<std::string, size_t> index_;   // Live id -> slot
+};
+
+#endif // INSTANCE_SET_H
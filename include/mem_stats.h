@@ -0,0 +1,115 @@
+#ifndef MEM_STATS_H
+#define MEM_STATS_H
+
+#include <chrono>
+#include <string>
+#include "proc_reader.h"
+
+/**
+ * /proc/meminfo fields kept by MemoryCollector (values converted from kB to bytes)
+ */
+enum MeminfoField {
+    kMemTotal,
+    kMemFree,
+    kMemAvailable,
+    kMemBuffers,
+    kMemCached,
+    kMemSwapCached,
+    kMemActive,
+    kMemInactive,
+    kMemDirty,
+    kMemWriteback,
+    kMemAnonPages,
+    kMemMapped,
+    kMemShmem,
+    kMemSlab,
+    kMemSReclaimable,
+    kMemSUnreclaim,
+    kMemSwapTotal,
+    kMemSwapFree,
+    kMemCommitLimit,
+    kMemCommittedAs,
+    kMeminfoFieldCount
+};
+
+/**
+ * /proc/vmstat counters kept by MemoryCollector
+ * Counters split per zone or per LRU on some kernels (allocstall_normal,
+ * workingset_refault_file, ...) are summed into one slot
+ */
+enum VmstatField {
+    kVmPgpgin,
+    kVmPgpgout,
+    kVmPswpin,
+    kVmPswpout,
+    kVmPgfault,
+    kVmPgmajfault,
+    kVmPgscanKswapd,
+    kVmPgscanDirect,
+    kVmPgstealKswapd,
+    kVmPgstealDirect,
+    kVmAllocstall,
+    kVmWorkingsetRefault,
+    kVmCompactStall,
+    kVmOomKill,
+    kVmstatFieldCount
+};
+
+struct MeminfoValues {
+    unsigned long long bytes[kMeminfoFieldCount] = {0};
+    bool present[kMeminfoFieldCount] = {false};
+};
+
+struct VmstatValues {
+    unsigned long long counts[kVmstatFieldCount] = {0};
+    bool present[kVmstatFieldCount] = {false};
+};
+
+/**
+ * Parse /proc/meminfo in one pass; keys are mapped to slots through a
+ * precomputed perfect hash, unknown keys are skipped
+ * @return false if MemTotal is missing
+ */
+bool parse_meminfo(const char* text, MeminfoValues& out);
+
+/**
+ * Parse /proc/vmstat in one pass, same slot lookup as parse_meminfo
+ * @return false if no known counter was found
+ */
+bool parse_vmstat(const char* text, VmstatValues& out);
+
+/**
+ * Short snake_case name of a field, e.g. "swap_total" or "pgmajfault"
+ */
+const char* meminfo_field_name(MeminfoField field);
+const char* vmstat_field_name(VmstatField field);
+
+/**
+ * Reads /proc/meminfo and /proc/vmstat from persistent file descriptors and
+ * turns vmstat counters into per-second rates between collect() calls
+ */
+class MemoryCollector {
+public:
+    explicit MemoryCollector(const std::string& proc_root = host_proc_root());
+
+    bool collect();
+
+    const MeminfoValues& meminfo() const { return meminfo_; }
+    const VmstatValues& vmstat() const { return vmstat_; }
+
+    /**
+     * Per-second rate of a vmstat counter, -1 until two readings exist
+     */
+    double vmstat_rate(VmstatField field) const { return rates_[field]; }
+
+private:
+    ProcFileReader meminfo_reader_;
+    ProcFileReader vmstat_reader_;
+    MeminfoValues meminfo_;
+    VmstatValues vmstat_;
+    double rates_[kVmstatFieldCount];
+    std::chrono::steady_clock::time_point last_collect_;
+    bool has_collected_;
+};
+
+#endif // MEM_STATS_H
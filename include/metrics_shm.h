@@ -0,0 +1,145 @@
+#ifndef METRICS_SHM_H
+#define METRICS_SHM_H
+
+/**
+ * Header-only reader for the metrics shared-memory snapshot
+ *
+ * The daemon publishes its latest status sample into a POSIX shared-memory
+ * segment (default "/metrics_monitor") guarded by a seqlock. Consumers map it
+ * read-only and read values with plain memory loads, no syscalls per read:
+ *
+ *   MetricsShmReader reader;
+ *   if (reader.open()) {
+ *       MetricsShmData data;
+ *       if (reader.read(data)) use(data.cpu_usage_percent);
+ *   }
+ *
+ * The layout is fixed; bump METRICS_SHM_VERSION on any change.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define METRICS_SHM_DEFAULT_NAME "/metrics_monitor"
+#define METRICS_SHM_MAGIC 0x48534d4du  // "MMSH"
+#define METRICS_SHM_VERSION 1u
+#define METRICS_SHM_MAX_THERMAL_ZONES 16
+
+/**
+ * Sample payload, copied as a whole under the seqlock
+ */
+struct MetricsShmData {
+    uint64_t sample_sequence;        // Sampler sequence number of this sample
+    int64_t timestamp_ms;            // Wall clock, milliseconds since epoch
+    double cpu_usage_percent;        // -1 if not yet known
+    int64_t ram_total_bytes;
+    int64_t ram_available_bytes;
+    int64_t ram_free_bytes;
+    int64_t uptime_seconds;
+    int32_t thermal_zone_count;
+    int32_t sample_interval_ms;      // Adaptive sampler period after this sample (0 from older writers)
+    int32_t thermal_millicelsius[METRICS_SHM_MAX_THERMAL_ZONES];
+};
+
+/**
+ * Segment layout: fixed header, seqlock counter, payload
+ */
+struct MetricsShmSegment {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t data_size;              // sizeof(MetricsShmData) of the writer
+    uint32_t writer_pid;
+    std::atomic<uint32_t> sequence;  // Odd while the writer is updating data
+    uint32_t padding;
+    MetricsShmData data;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "seqlock counter must be lock-free to be shared across processes");
+
+class MetricsShmReader {
+public:
+    MetricsShmReader() = default;
+    MetricsShmReader(const MetricsShmReader&) = delete;
+    MetricsShmReader& operator=(const MetricsShmReader&) = delete;
+    ~MetricsShmReader() { close(); }
+
+    /**
+     * Map the segment read-only
+     * @return false if the segment does not exist or has an unknown layout
+     */
+    bool open(const char* name = METRICS_SHM_DEFAULT_NAME) {
+        close();
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MetricsShmSegment)) {
+            ::close(fd);
+            return false;
+        }
+        void* addr = mmap(nullptr, sizeof(MetricsShmSegment), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+        segment_ = static_cast<const MetricsShmSegment*>(addr);
+        if (segment_->magic != METRICS_SHM_MAGIC || segment_->version != METRICS_SHM_VERSION ||
+            segment_->data_size != sizeof(MetricsShmData)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (segment_ != nullptr) {
+            munmap(const_cast<MetricsShmSegment*>(segment_), sizeof(MetricsShmSegment));
+            segment_ = nullptr;
+        }
+    }
+
+    bool is_open() const { return segment_ != nullptr; }
+
+    /**
+     * Copy a consistent snapshot
+     * @return false if not open, nothing published yet, or the writer kept
+     *         updating for max_retries attempts
+     */
+    bool read(MetricsShmData& out, int max_retries = 1000) const {
+        if (segment_ == nullptr) {
+            return false;
+        }
+        for (int i = 0; i < max_retries; ++i) {
+            uint32_t before = segment_->sequence.load(std::memory_order_acquire);
+            if (before & 1u) {
+                continue;  // Writer in progress
+            }
+            std::memcpy(&out, &segment_->data, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t after = segment_->sequence.load(std::memory_order_relaxed);
+            if (before == after) {
+                return before != 0;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Sequence counter of the latest completed write, cheap change check
+     */
+    uint32_t version() const {
+        return segment_ != nullptr ? segment_->sequence.load(std::memory_order_acquire) : 0;
+    }
+
+private:
+    const MetricsShmSegment* segment_ = nullptr;
+};
+
+#endif // METRICS_SHM_H
@@ -0,0 +1,171 @@
+#ifndef NET_STATS_H
+#define NET_STATS_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include "proc_reader.h"
+
+/**
+ * Counters and rates of one network interface from /proc/net/dev
+ */
+struct NetInterfaceStats {
+    std::string name;
+    bool present = false;                 // Seen in the latest pass (interfaces missing from it are dropped)
+    unsigned long long rx_bytes = 0;
+    unsigned long long rx_packets = 0;
+    unsigned long long rx_errors = 0;
+    unsigned long long rx_dropped = 0;
+    unsigned long long tx_bytes = 0;
+    unsigned long long tx_packets = 0;
+    unsigned long long tx_errors = 0;
+    unsigned long long tx_dropped = 0;
+    double rx_bytes_per_sec = -1;         // -1 until two samples exist
+    double tx_bytes_per_sec = -1;
+    double rx_packets_per_sec = -1;
+    double tx_packets_per_sec = -1;
+    double rx_errors_per_sec = -1;
+    double tx_errors_per_sec = -1;
+    double rx_dropped_per_sec = -1;
+    double tx_dropped_per_sec = -1;
+};
+
+/**
+ * Single-pass /proc/net/dev parser with per-interface slots
+ * An interface keeps its slot while it is listed; slots of interfaces missing
+ * from a whole pass are dropped and the remaining ones compacted
+ */
+class NetDevCollector {
+public:
+    explicit NetDevCollector(const std::string& path = host_proc_root() + "/net/dev");
+
+    /**
+     * Re-read /proc/net/dev and update counters and rates in place
+     */
+    bool collect();
+
+    /**
+     * Interfaces listed in the latest pass, in first-seen order
+     */
+    const std::vector<NetInterfaceStats>& interfaces() const { return slots_; }
+
+private:
+    size_t slot_for(const char* name, size_t len, size_t line_index);
+
+    ProcFileReader reader_;
+    std::vector<NetInterfaceStats> slots_;
+    std::vector<size_t> line_slots_;      // Slot matched by each line last pass
+    std::chrono::steady_clock::time_point last_time_;
+    bool has_previous_;
+};
+
+/**
+ * TCP/UDP counters kept from /proc/net/snmp and /proc/net/netstat
+ */
+enum NetProtoCounter {
+    kTcpActiveOpens,
+    kTcpPassiveOpens,
+    kTcpAttemptFails,
+    kTcpEstabResets,
+    kTcpCurrEstab,              // Gauge: connections in ESTABLISHED or CLOSE-WAIT
+    kTcpInSegs,
+    kTcpOutSegs,
+    kTcpRetransSegs,
+    kTcpInErrs,
+    kTcpOutRsts,
+    kTcpListenOverflows,        // TcpExt: accept queue full
+    kTcpListenDrops,
+    kTcpTimeouts,
+    kTcpLostRetransmit,
+    kTcpBacklogDrop,
+    kTcpAbortOnMemory,
+    kUdpInDatagrams,
+    kUdpNoPorts,
+    kUdpInErrors,
+    kUdpOutDatagrams,
+    kUdpRcvbufErrors,           // Datagrams dropped because the socket receive buffer was full
+    kUdpSndbufErrors,
+    kNetProtoCounterCount
+};
+
+/**
+ * Socket counts from /proc/net/sockstat and sockstat6 (memory in pages)
+ */
+struct SockStat {
+    long long sockets_used = -1;
+    long long tcp_inuse = -1;
+    long long tcp_orphan = -1;
+    long long tcp_time_wait = -1;
+    long long tcp_alloc = -1;
+    long long tcp_mem_pages = -1;
+    long long udp_inuse = -1;
+    long long udp_mem_pages = -1;
+    long long tcp6_inuse = -1;
+    long long udp6_inuse = -1;
+};
+
+/**
+ * Parse /proc/net/sockstat or sockstat6 contents into out (fields not present are left as is)
+ */
+bool parse_sockstat(const char* text, SockStat& out);
+
+/**
+ * Protocol counters from the paired header/value lines of /proc/net/snmp and
+ * /proc/net/netstat, plus socket counts from sockstat
+ * Header lines are tokenized once into a column -> counter map and only
+ * re-indexed when their text changes (e.g. after a kernel upgrade)
+ */
+class NetProtoCollector {
+public:
+    explicit NetProtoCollector(const std::string& proc_root = host_proc_root());
+
+    bool collect();
+
+    bool has(NetProtoCounter counter) const { return present_[counter]; }
+    unsigned long long value(NetProtoCounter counter) const { return values_[counter]; }
+
+    /**
+     * Per-second rate since the previous collect(), -1 until then or for gauges
+     */
+    double rate(NetProtoCounter counter) const { return rates_[counter]; }
+
+    /**
+     * RetransSegs / OutSegs over the last interval in percent, -1 until two readings exist
+     */
+    double tcp_retransmit_percent() const { return tcp_retransmit_percent_; }
+
+    const SockStat& sockstat() const { return sockstat_; }
+
+    /**
+     * Status key of a counter, e.g. "retrans_segs", and its group ("tcp", "udp")
+     */
+    static const char* counter_name(NetProtoCounter counter);
+    static const char* counter_group(NetProtoCounter counter);
+    static bool counter_is_gauge(NetProtoCounter counter);
+
+private:
+    // Column -> counter slot (-1 for untracked columns) of one header line
+    struct HeaderIndex {
+        std::string header;
+        std::vector<int> slots;
+    };
+
+    void parse_pairs(const ProcFileReader& reader, std::vector<HeaderIndex>& index);
+
+    ProcFileReader snmp_reader_;
+    ProcFileReader netstat_reader_;
+    ProcFileReader sockstat_reader_;
+    ProcFileReader sockstat6_reader_;
+    std::vector<HeaderIndex> snmp_index_;
+    std::vector<HeaderIndex> netstat_index_;
+    unsigned long long values_[kNetProtoCounterCount];
+    unsigned long long previous_[kNetProtoCounterCount];
+    bool present_[kNetProtoCounterCount];
+    double rates_[kNetProtoCounterCount];
+    double tcp_retransmit_percent_;
+    SockStat sockstat_;
+    std::chrono::steady_clock::time_point last_time_;
+    bool has_previous_;
+};
+
+#endif // NET_STATS_H
@@ -0,0 +1,96 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "proc_reader.h"
+
+enum PerfEvent {
+    kPerfCycles,
+    kPerfInstructions,
+    kPerfCacheMisses,
+    kPerfBranchMisses,
+    kPerfContextSwitches,
+    kPerfCpuMigrations,
+    kPerfPageFaults,
+    kPerfEventCount
+};
+
+/**
+ * Counter deltas and derived ratios of one target since the previous collect()
+ * Each interval is scaled for multiplexing on its own (raw delta * enabled
+ * delta / running delta); derived ratios are -1 when the counters they need
+ * are not part of the current mode
+ */
+struct PerfTargetStats {
+    std::string name;                 // "system" or a cgroup v2 path
+    bool available = false;
+    double deltas[kPerfEventCount] = {0};
+    double ipc = -1;                  // instructions per cycle
+    double cache_misses_per_kinstr = -1;
+    double branch_misses_per_kinstr = -1;
+    double context_switches_per_sec = -1;
+    double cpu_migrations_per_sec = -1;
+    double page_faults_per_sec = -1;
+    double running_ratio = 1;         // < 1 when the PMU was multiplexed during the interval
+};
+
+/**
+ * perf_event_open() counter groups, one per online CPU and target
+ * Hardware mode counts cycles, instructions, cache-misses, branch-misses and
+ * context-switches; when the PMU is unavailable (VMs, CI) it falls back to
+ * software events (context-switches, cpu-migrations, page-faults).
+ * Each group is read with a single read() using PERF_FORMAT_GROUP.
+ */
+class PerfCollector {
+public:
+    PerfCollector(bool system_wide, const std::vector<std::string>& cgroups,
+                  const std::string& cgroup_root = host_sys_root() + "/fs/cgroup",
+                  const std::string& sys_root = host_sys_root());
+    ~PerfCollector();
+
+    PerfCollector(const PerfCollector&) = delete;
+    PerfCollector& operator=(const PerfCollector&) = delete;
+
+    bool collect();
+
+    /**
+     * "hardware", "software" or "unavailable"
+     */
+    const std::string& mode() const { return mode_; }
+
+    /**
+     * Why counters could not be opened (empty when mode() is not "unavailable")
+     */
+    const std::string& error() const { return error_; }
+
+    const std::vector<PerfTargetStats>& targets() const { return targets_; }
+
+private:
+    struct Group {
+        size_t target;
+        std::vector<int> fds;         // fds[0] is the leader
+        // Unscaled values of the previous read; the counters only grow
+        uint64_t previous[kPerfEventCount];
+        uint64_t previous_enabled;
+        uint64_t previous_running;
+        bool has_previous;
+    };
+
+    bool open_groups(const std::vector<PerfEvent>& events, const std::vector<int>& cpus,
+                     const std::vector<int>& cgroup_fds);
+    void close_groups();
+
+    std::string mode_;
+    std::string error_;
+    std::vector<PerfEvent> events_;
+    std::vector<Group> groups_;
+    std::vector<PerfTargetStats> targets_;
+    std::vector<char> read_buffer_;
+    std::chrono::steady_clock::time_point last_collect_;
+    bool has_collected_;
+};
+
+#endif // PERF_STATS_H
@@ -0,0 +1,107 @@
+#ifndef POWER_STATS_H
+#define POWER_STATS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "proc_reader.h"
+
+/**
+ * One powercap (RAPL) zone, e.g. intel-rapl:0 "package-0" or intel-rapl:0:1 "dram"
+ */
+struct PowerDomain {
+    std::string zone;                 // powercap directory name
+    std::string name;                 // package-N, core, uncore, dram, psys
+    long long energy_uj = 0;
+    long long max_energy_range_uj = 0;
+    double watts = -1;                // Average since the previous collect(), -1 until two readings
+    bool ok = false;
+};
+
+/**
+ * One /sys/class/power_supply device (battery, mains, USB, solar charger)
+ */
+struct PowerSupply {
+    std::string name;
+    std::string type;                 // Battery, Mains, USB, ...
+    std::string status;               // Charging, Discharging, Full, ... (batteries)
+    int online = -1;                  // -1 if not reported
+    int capacity_percent = -1;
+    double watts = -1;                // power_now, or voltage_now * current_now
+};
+
+/**
+ * One hwmon power reading: power*_input, or bus voltage * current for
+ * INA3221-style monitors that expose in<N>_input and curr<N>_input only
+ */
+struct PowerSensor {
+    std::string chip;
+    std::string label;
+    double watts = 0;
+    bool ok = false;
+};
+
+/**
+ * Energy and power readings from powercap, power_supply and hwmon under a sysfs root
+ * Attribute files are opened once; RAPL watts come from energy_uj deltas with
+ * wraparound at max_energy_range_uj
+ */
+class PowerCollector {
+public:
+    explicit PowerCollector(const std::string& sys_root = host_sys_root());
+    ~PowerCollector();
+
+    PowerCollector(const PowerCollector&) = delete;
+    PowerCollector& operator=(const PowerCollector&) = delete;
+
+    bool collect();
+
+    /**
+     * collect() with an explicit timestamp; RAPL watts divide the energy
+     * delta by the time since the previous pass
+     */
+    bool collect(std::chrono::steady_clock::time_point now);
+
+    const std::vector<PowerDomain>& domains() const { return domains_; }
+    const std::vector<PowerSupply>& supplies() const { return supplies_; }
+    const std::vector<PowerSensor>& sensors() const { return sensors_; }
+
+    /**
+     * Sum of package-level RAPL domains, -1 if none has a rate yet
+     */
+    double package_watts() const;
+
+private:
+    struct SupplyFiles {
+        int status_fd = -1;
+        int online_fd = -1;
+        int capacity_fd = -1;
+        int power_fd = -1;            // power_now (uW)
+        int voltage_fd = -1;          // voltage_now (uV)
+        int current_fd = -1;          // current_now (uA)
+    };
+
+    struct SensorFiles {
+        int power_fd = -1;            // power<N>_input (uW)
+        int voltage_fd = -1;          // in<N>_input (mV)
+        int current_fd = -1;          // curr<N>_input (mA)
+    };
+
+    void discover(const std::string& sys_root);
+
+    std::vector<PowerDomain> domains_;
+    std::vector<int> energy_fds_;
+    std::vector<PowerSupply> supplies_;
+    std::vector<SupplyFiles> supply_files_;
+    std::vector<PowerSensor> sensors_;
+    std::vector<SensorFiles> sensor_files_;
+    std::chrono::steady_clock::time_point last_collect_;
+    bool has_collected_;
+};
+
+/**
+ * Energy consumed between two energy_uj readings of a counter that wraps at max_range_uj
+ */
+long long energy_delta_uj(long long previous, long long current, long long max_range_uj);
+
+#endif // POWER_STATS_H
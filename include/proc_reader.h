@@ -0,0 +1,104 @@
+#ifndef PROC_READER_H
+#define PROC_READER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Keeps a procfs/sysfs file open and re-reads it from offset 0 into a
+ * reusable buffer, avoiding open()/close() and allocations per sample
+ */
+class ProcFileReader {
+public:
+    explicit ProcFileReader(const std::string& path);
+    ~ProcFileReader();
+
+    ProcFileReader(const ProcFileReader&) = delete;
+    ProcFileReader& operator=(const ProcFileReader&) = delete;
+
+    /**
+     * Re-read the whole file; data() is NUL-terminated
+     * @return false if the file could not be opened or read
+     */
+    bool read();
+
+    const char* data() const { return buffer_.data(); }
+    size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+    bool is_open() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+
+    /**
+     * errno of the last failed open or read, 0 after a successful read()
+     */
+    int error() const { return error_; }
+
+private:
+    std::string path_;
+    int fd_;
+    int error_;
+    std::vector<char> buffer_;
+    size_t size_;
+};
+
+/**
+ * pread() a whole file from offset 0 into buffer, growing it as needed
+ * @return false on read error; buffer is NUL-terminated at size on success
+ */
+bool pread_all(int fd, std::vector<char>& buffer, size_t& size);
+
+/**
+ * pread() a small sysfs attribute from offset 0 and parse it as an integer
+ * @return false on read or parse failure
+ */
+bool read_fd_long_long(int fd, long long& out);
+
+/**
+ * Read a small text attribute (first line, trailing newline removed)
+ * @return empty string if the file cannot be read
+ */
+std::string read_sysfs_string(const std::string& path);
+
+/**
+ * Entries of dir named prefix followed by a number (e.g. "hwmon3"), sorted numerically
+ */
+std::vector<std::string> list_numbered_entries(const std::string& dir, const std::string& prefix);
+
+/**
+ * Entries of dir other than "." and "..", sorted by name
+ */
+std::vector<std::string> list_entries(const std::string& dir);
+
+/**
+ * Open a sysfs attribute to keep for read_fd_long_long()/pread_all()
+ * @return fd (O_RDONLY | O_CLOEXEC), or -1 if the attribute does not exist
+ */
+int open_attribute(const std::string& path);
+
+/**
+ * Close fd if open and set it to -1
+ */
+void close_fd(int& fd);
+
+/**
+ * Where procfs, sysfs and the root filesystem are read from: "/proc", "/sys"
+ * and "/" unless the HOST_PROC, HOST_SYS or HOST_ROOT environment variables
+ * point elsewhere (host filesystems mounted into a container, or a recorded
+ * fixture tree). Every collector builds its default paths from these
+ */
+const std::string& host_proc_root();
+const std::string& host_sys_root();
+
+/**
+ * Prefix for paths on the host root filesystem; empty when it is "/"
+ */
+const std::string& host_rootfs();
+
+/**
+ * Override the roots from config; empty arguments and roots already given
+ * through the environment are left unchanged
+ * Call once at startup, before any collector is constructed
+ */
+void set_host_paths(const std::string& proc_root, const std::string& sys_root, const std::string& rootfs);
+
+#endif // PROC_READER_H
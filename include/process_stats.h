@@ -0,0 +1,180 @@
+#ifndef PROCESS_STATS_H
+#define PROCESS_STATS_H
+
+#include "config.h"
+#include "proc_reader.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Fields of /proc/[pid]/stat used by the process collectors
+ */
+struct ProcPidStat {
+    std::string comm;
+    char state = '?';
+    unsigned long long utime_ticks = 0;
+    unsigned long long stime_ticks = 0;
+    long num_threads = 0;
+    unsigned long long starttime_ticks = 0;   // Identifies the process across PID reuse
+    long long rss_pages = 0;
+};
+
+/**
+ * Parse /proc/[pid]/stat; comm may contain spaces and parentheses
+ */
+bool parse_proc_pid_stat(const char* text, ProcPidStat& out);
+
+/**
+ * Resource usage of the processes bound to one instance, summed over its PIDs
+ * Rates are -1 until two samples of the same PIDs are available
+ */
+struct InstanceProcessStats {
+    std::string id;
+    std::string bound_by;             // "pidfile", "cgroup" or "cmdline"
+    std::vector<int> pids;
+    long num_threads = 0;
+    unsigned long long cpu_time_ticks = 0;
+    double cpu_percent = -1;          // 100 = one full core
+    long long rss_bytes = 0;
+    long long vm_bytes = 0;
+    bool io_available = false;        // /proc/[pid]/io needs ptrace access to the process
+    int io_errno = 0;                 // Why io is unavailable while pids is non-empty (EACCES, ENOENT, ...)
+    long long read_bytes = 0;
+    long long write_bytes = 0;
+    double read_bytes_per_sec = -1;
+    double write_bytes_per_sec = -1;
+};
+
+/**
+ * Samples /proc/[pid]/stat, statm and io for the PIDs bound to configured instances
+ * PIDs are re-resolved only when a tracked process exits (or, for cgroups, when
+ * cgroup.procs changes); per-PID files stay open between samples
+ */
+class InstanceProcessCollector {
+public:
+    explicit InstanceProcessCollector(const std::vector<InstanceBinding>& bindings,
+                                      const std::string& proc_root = host_proc_root(),
+                                      const std::string& cgroup_root = host_sys_root() + "/fs/cgroup");
+
+    InstanceProcessCollector(const InstanceProcessCollector&) = delete;
+    InstanceProcessCollector& operator=(const InstanceProcessCollector&) = delete;
+
+    /**
+     * Sample the processes of one instance
+     * @return nullptr if the instance has no binding
+     */
+    const InstanceProcessStats* collect(const std::string& id);
+
+private:
+    struct TrackedProcess {
+        int pid = 0;
+        unsigned long long starttime_ticks = 0;
+        std::unique_ptr<ProcFileReader> stat;
+        std::unique_ptr<ProcFileReader> statm;
+        std::unique_ptr<ProcFileReader> io;
+        bool has_previous = false;
+        unsigned long long prev_cpu_ticks = 0;
+        long long prev_read_bytes = 0;
+        long long prev_write_bytes = 0;
+    };
+
+    struct Instance {
+        InstanceBinding binding;
+        InstanceProcessStats stats;
+        std::vector<TrackedProcess> processes;
+        std::unique_ptr<ProcFileReader> cgroup_procs;
+        std::chrono::steady_clock::time_point last_sample;
+        std::chrono::steady_clock::time_point last_resolve;
+        bool resolved = false;
+    };
+
+    std::vector<int> resolve_pids(Instance& instance);
+    void track(Instance& instance, const std::vector<int>& pids);
+
+    std::string proc_root_;
+    std::string cgroup_root_;
+    std::vector<Instance> instances_;
+    std::unordered_map<std::string, size_t> index_;   // Instance id -> instances_ slot
+    long ticks_per_second_;
+    long page_size_;
+};
+
+/**
+ * One row of the process table
+ */
+struct ProcessEntry {
+    int pid = 0;
+    unsigned int uid = 0;
+    std::string comm;
+    char state = '?';
+    long num_threads = 0;
+    double cpu_percent = 0;           // Since the previous scan; lifetime average for new PIDs
+    long long rss_bytes = 0;
+    unsigned long long cpu_time_ticks = 0;
+};
+
+enum class ProcessSortKey {
+    Cpu,
+    Memory
+};
+
+/**
+ * Parse "cpu" or "memory" (also "mem", "rss")
+ */
+bool parse_process_sort_key(const std::string& name, ProcessSortKey& out);
+
+/**
+ * Incremental /proc scanner for top-N process listings
+ * Each known PID keeps an open /proc/[pid]/stat fd and its last CPU ticks;
+ * a scan lists /proc, opens only PIDs that appeared since the previous scan,
+ * drops those that vanished, and keeps the best N rows in a bounded heap
+ */
+class ProcessTableScanner {
+public:
+    explicit ProcessTableScanner(const std::string& proc_root = host_proc_root());
+    ~ProcessTableScanner();
+
+    ProcessTableScanner(const ProcessTableScanner&) = delete;
+    ProcessTableScanner& operator=(const ProcessTableScanner&) = delete;
+
+    /**
+     * Scan /proc and return the top_n processes by key, best first
+     */
+    std::vector<ProcessEntry> scan(size_t top_n, ProcessSortKey key);
+
+    size_t process_count() const { return cache_.size(); }
+    size_t last_new() const { return last_new_; }
+    size_t last_exited() const { return last_exited_; }
+    double last_scan_us() const { return last_scan_us_; }
+
+private:
+    struct CachedProcess {
+        int stat_fd = -1;             // -1 once over the fd budget: reopened per scan
+        unsigned int uid = 0;
+        unsigned long long starttime_ticks = 0;
+        unsigned long long last_ticks = 0;
+        bool has_previous = false;
+        unsigned long generation = 0;
+    };
+
+    bool read_stat(int pid, CachedProcess& cached, char* buf, size_t buf_size, size_t& len);
+    double read_uptime_seconds();
+
+    std::string proc_root_;
+    std::unordered_map<int, CachedProcess> cache_;
+    unsigned long generation_;
+    size_t open_fds_;
+    size_t fd_budget_;
+    long ticks_per_second_;
+    long page_size_;
+    int uptime_fd_;
+    std::chrono::steady_clock::time_point last_scan_;
+    size_t last_new_;
+    size_t last_exited_;
+    double last_scan_us_;
+};
+
+#endif // PROCESS_STATS_H
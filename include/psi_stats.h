@@ -0,0 +1,92 @@
+#ifndef PSI_STATS_H
+#define PSI_STATS_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "proc_reader.h"
+
+/**
+ * One "some" or "full" line of a pressure file
+ */
+struct PsiLine {
+    double avg10 = -1;          // Percent of wall time stalled, -1 if unavailable
+    double avg60 = -1;
+    double avg300 = -1;
+    unsigned long long total_us = 0;  // Cumulative stall time in microseconds
+};
+
+/**
+ * Pressure of one resource (cpu, memory, io) system-wide or for a cgroup
+ */
+struct PsiResource {
+    std::string name;
+    bool available = false;
+    bool has_full = false;      // System-wide cpu "full" is only meaningful for cgroups
+    PsiLine some;
+    PsiLine full;
+};
+
+/**
+ * Pressure files of one cgroup v2 directory
+ */
+struct PsiCgroup {
+    std::string path;           // Relative to the cgroup2 mount
+    std::vector<PsiResource> resources;
+};
+
+/**
+ * Reads /proc/pressure/{cpu,memory,io} and <cgroup>/{cpu,memory,io}.pressure
+ * from persistent file descriptors
+ */
+class PsiCollector {
+public:
+    explicit PsiCollector(const std::vector<std::string>& cgroups = std::vector<std::string>(),
+                          const std::string& proc_pressure_dir = host_proc_root() + "/pressure",
+                          const std::string& cgroup_root = host_sys_root() + "/fs/cgroup");
+
+    bool collect();
+
+    const std::vector<PsiResource>& system() const { return system_; }
+    const std::vector<PsiCgroup>& cgroups() const { return cgroups_; }
+
+    /**
+     * System-wide resource by name ("cpu", "memory", "io"), nullptr if unknown
+     */
+    const PsiResource* find(const std::string& name) const;
+
+private:
+    std::vector<PsiResource> system_;
+    std::vector<PsiCgroup> cgroups_;
+    std::vector<std::unique_ptr<ProcFileReader>> readers_;  // system_ then each cgroup, in order
+};
+
+/**
+ * Parse the contents of a pressure file into res
+ */
+bool parse_psi(const char* text, PsiResource& res);
+
+/**
+ * Watch PSI triggers with poll() and invoke on_event from the watcher thread
+ * Each trigger is "<resource> <some|full> <stall_us> <window_us>", e.g.
+ * "memory some 150000 2000000"; a resource may be prefixed with a cgroup path
+ * ("system.slice/vision.service:memory some 150000 2000000")
+ * @return number of triggers that were armed
+ */
+int start_psi_trigger_watcher(const std::vector<std::string>& triggers,
+                              std::function<void(const std::string& trigger)> on_event,
+                              const std::string& proc_pressure_dir = host_proc_root() + "/pressure",
+                              const std::string& cgroup_root = host_sys_root() + "/fs/cgroup");
+
+/**
+ * Stop the watcher thread and close trigger file descriptors
+ */
+void stop_psi_trigger_watcher();
+
+/**
+ * Number of trigger events delivered since startup
+ */
+unsigned long long get_psi_trigger_event_count();
+
+#endif // PSI_STATS_H
@@ -0,0 +1,124 @@
+#ifndef SCHED_STATS_H
+#define SCHED_STATS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "proc_reader.h"
+
+/**
+ * CPU jiffies from one cpu line of /proc/stat
+ */
+struct CpuTimes {
+    long long idle = 0;   // idle + iowait
+    long long total = 0;  // all non-guest states
+};
+
+/**
+ * Everything kept from one read of /proc/stat
+ */
+struct ProcStat {
+    CpuTimes cpu;                         // Aggregate "cpu" line
+    std::vector<CpuTimes> per_cpu;        // Indexed by CPU number; offline CPUs stay zero
+    unsigned long long context_switches = 0;
+    unsigned long long interrupts = 0;    // First value of the intr line (all IRQs)
+    unsigned long long softirqs = 0;
+    unsigned long long forks = 0;         // "processes"
+    int procs_running = 0;
+    int procs_blocked = 0;
+};
+
+/**
+ * /proc/loadavg
+ */
+struct LoadAvg {
+    double load1 = -1;
+    double load5 = -1;
+    double load15 = -1;
+    int runnable = 0;                     // Currently runnable scheduling entities
+    int total = 0;                        // Scheduling entities (tasks) that exist
+};
+
+/**
+ * One row of /proc/softirqs (HI, TIMER, NET_TX, NET_RX, ...)
+ */
+struct SoftirqRow {
+    std::string name;
+    unsigned long long total = 0;
+    std::vector<unsigned long long> per_cpu;   // Column order of the header
+    double per_sec = -1;                       // -1 until two readings exist
+    std::vector<double> per_cpu_per_sec;
+};
+
+/**
+ * Parse the whole of /proc/stat in one pass
+ */
+bool parse_proc_stat(const char* text, ProcStat& out);
+
+/**
+ * Parse "0.31 0.39 0.40 2/71 10994"
+ */
+bool parse_loadavg(const char* text, LoadAvg& out);
+
+/**
+ * Parse /proc/softirqs; rows are updated in place so rates can be derived
+ * @param cpus receives the CPU numbers of the header columns
+ */
+bool parse_softirqs(const char* text, std::vector<int>& cpus, std::vector<SoftirqRow>& rows);
+
+/**
+ * CPU usage in percent between two readings, -1 if prev is empty
+ */
+double cpu_usage_between(const CpuTimes& prev, const CpuTimes& cur);
+
+/**
+ * CPU usage and scheduler activity from /proc/stat, /proc/loadavg and
+ * /proc/softirqs, each re-read from a persistent descriptor into one buffer
+ * Rates cover the time since the previous collect() and are -1 until then
+ */
+class SchedCollector {
+public:
+    explicit SchedCollector(const std::string& proc_root = host_proc_root());
+
+    bool collect();
+
+    const ProcStat& stat() const { return stat_; }
+    const LoadAvg& loadavg() const { return loadavg_; }
+
+    double cpu_usage_percent() const { return cpu_usage_percent_; }
+    const std::vector<double>& per_cpu_usage_percent() const { return per_cpu_usage_percent_; }
+    double context_switches_per_sec() const { return context_switches_per_sec_; }
+    double interrupts_per_sec() const { return interrupts_per_sec_; }
+    double forks_per_sec() const { return forks_per_sec_; }
+
+    /**
+     * CPU numbers of the /proc/softirqs columns and its rows
+     */
+    const std::vector<int>& softirq_cpus() const { return softirq_cpus_; }
+    const std::vector<SoftirqRow>& softirqs() const { return softirqs_; }
+
+    /**
+     * Row by name ("NET_RX"), nullptr if the kernel does not have it
+     */
+    const SoftirqRow* find_softirq(const char* name) const;
+
+private:
+    ProcFileReader stat_reader_;
+    ProcFileReader loadavg_reader_;
+    ProcFileReader softirqs_reader_;
+    ProcStat stat_;
+    ProcStat previous_stat_;
+    LoadAvg loadavg_;
+    std::vector<int> softirq_cpus_;
+    std::vector<SoftirqRow> softirqs_;
+    std::vector<unsigned long long> previous_softirq_;  // Row totals, then per-CPU values row by row
+    double cpu_usage_percent_;
+    std::vector<double> per_cpu_usage_percent_;
+    double context_switches_per_sec_;
+    double interrupts_per_sec_;
+    double forks_per_sec_;
+    std::chrono::steady_clock::time_point last_collect_;
+    bool has_collected_;
+};
+
+#endif // SCHED_STATS_H
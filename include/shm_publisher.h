@@ -0,0 +1,24 @@
+#ifndef SHM_PUBLISHER_H
+#define SHM_PUBLISHER_H
+
+#include <string>
+#include "status_sampler.h"
+
+/**
+ * Create (or take over) the shared-memory snapshot segment as its only writer
+ * Readers use the header-only MetricsShmReader from metrics_shm.h
+ * @return false if the segment cannot be created or another writer holds it
+ */
+bool open_metrics_shm(const std::string& name);
+
+/**
+ * Publish a sample into the segment under the seqlock (no-op if not open)
+ */
+void publish_metrics_shm(const StatusSample& sample);
+
+/**
+ * Unmap and remove the segment
+ */
+void close_metrics_shm();
+
+#endif // SHM_PUBLISHER_H
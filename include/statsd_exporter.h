@@ -0,0 +1,28 @@
+#ifndef STATSD_EXPORTER_H
+#define STATSD_EXPORTER_H
+
+#include <string>
+#include <vector>
+#include "config.h"
+#include "status_sampler.h"
+
+/**
+ * Start the StatsD push exporter thread if enabled in config
+ * Pushes the latest sampler output as gauges over UDP; never blocks the sampler
+ */
+void start_statsd_exporter(const StatsdConfig& config);
+
+/**
+ * Stop the StatsD push exporter thread
+ */
+void stop_statsd_exporter();
+
+/**
+ * Format a sample as StatsD gauge lines and pack them into datagram payloads
+ * of at most max_packet_bytes each (a line is never split across datagrams)
+ */
+std::vector<std::string> build_statsd_packets(const StatusSample& sample,
+                                              const std::string& prefix,
+                                              size_t max_packet_bytes);
+
+#endif // STATSD_EXPORTER_H
@@ -0,0 +1,91 @@
+#ifndef STATUS_SAMPLER_H
+#define STATUS_SAMPLER_H
+
+#include <cstdint>
+#include <functional>
+#include "config.h"
+
+#define STATUS_SAMPLE_MAX_THERMAL_ZONES 16
+#define STATUS_SAMPLE_MAX_POWER_READINGS 8
+#define STATUS_SAMPLE_POWER_NAME_LEN 32
+
+/**
+ * One background sample of the core system metrics
+ */
+struct StatusSample {
+    uint64_t sequence = 0;           // Increments with every published sample
+    long long timestamp_ms = 0;      // Wall clock, milliseconds since epoch
+    double cpu_usage_percent = -1;   // -1 until two /proc/stat readings exist
+    double load1 = -1;               // /proc/loadavg
+    double load5 = -1;
+    double load15 = -1;
+    int procs_running = 0;
+    int procs_blocked = 0;           // Waiting on I/O
+    double context_switches_per_sec = -1;
+    double interrupts_per_sec = -1;
+    double net_rx_softirqs_per_sec = -1;   // All CPUs
+    long long ram_total_bytes = 0;
+    long long ram_free_bytes = 0;
+    long long ram_available_bytes = 0;
+    long long swap_total_bytes = 0;
+    long long swap_free_bytes = 0;
+    double swap_in_pages_per_sec = -1;   // -1 until two /proc/vmstat readings exist
+    double swap_out_pages_per_sec = -1;
+    double major_faults_per_sec = -1;
+    double direct_reclaim_pages_per_sec = -1;  // pgsteal_direct: pages reclaimed by allocations stalled on reclaim
+    long long oom_kills = -1;        // Since boot, -1 if the kernel does not count them
+    long long uptime_seconds = 0;
+    int thermal_zone_count = 0;      // Entries used in thermal_millicelsius
+    int thermal_millicelsius[STATUS_SAMPLE_MAX_THERMAL_ZONES] = {};
+    bool thermal_throttling = false; // Hot and CPU frequency held below maximum
+    double psi_cpu_some_avg10 = -1;  // Pressure stall percentages, -1 if PSI is unavailable
+    double psi_memory_some_avg10 = -1;
+    double psi_memory_full_avg10 = -1;
+    double psi_io_some_avg10 = -1;
+    double psi_io_full_avg10 = -1;
+    int power_reading_count = 0;     // RAPL domains, then hwmon power sensors, then power supplies
+    char power_names[STATUS_SAMPLE_MAX_POWER_READINGS][STATUS_SAMPLE_POWER_NAME_LEN] = {};
+    double power_watts[STATUS_SAMPLE_MAX_POWER_READINGS] = {};
+    int sample_interval_ms = 0;      // Period until the next sample (adaptive)
+    const char* sampling_reason = "";  // Why: "change", "trigger", "demand", "stable" or "fixed"
+};
+
+/**
+ * Callback run on the sampler thread after each sample; must not block
+ */
+typedef std::function<void(const StatusSample&)> StatusSampleListener;
+
+/**
+ * Register a listener (call before start_status_sampler)
+ */
+void add_status_sample_listener(StatusSampleListener listener);
+
+/**
+ * Start the background sampler thread (no-op if already running)
+ */
+void start_status_sampler(const SamplerConfig& config);
+
+/**
+ * Stop the background sampler thread and wait for it to exit
+ */
+void stop_status_sampler();
+
+/**
+ * Wake the sampler to take a sample now (e.g. on a PSI stall event)
+ */
+void request_status_sample();
+
+/**
+ * A client consumes samples and wants one at least every interval_ms
+ * (0 = the fastest configured rate); the sampler keeps that rate for
+ * demand_hold_ms after the last call. Cheap enough to call per request
+ */
+void note_status_sample_demand(int interval_ms = 0);
+
+/**
+ * Copy the most recent sample
+ * @return false if no sample has been taken yet
+ */
+bool get_latest_status_sample(StatusSample& out);
+
+#endif // STATUS_SAMPLER_H
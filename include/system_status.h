@@ -2,12 +2,43 @@
 #define SYSTEM_STATUS_H
 
 #include <string>
+#include "config.h"
+#include "process_stats.h"
+#include "sched_stats.h"
 
 /**
  * Get current system status in JSON format
+ * Sections are the latest output of the status collectors; nothing is read
+ * from /proc or /sys on the request path once the collectors are running
  * @return JSON string containing CPU usage, RAM usage, disk usage, etc.
  */
 std::string get_system_status_json();
 
+/**
+ * CPU, memory and I/O of the processes bound to an instance (see "instance_bindings")
+ * Rates are computed against the previous request for the same instance
+ * @return false if the instance has no process binding
+ */
+bool get_instance_metrics_json(const std::string& instance_id, std::string& out);
+
+/**
+ * Top processes by CPU or memory from the incremental /proc scanner
+ * CPU percentages cover the time since the previous call
+ */
+std::string get_process_table_json(size_t top_n, ProcessSortKey sort_key);
+
+/**
+ * Apply collector options from config (call once at startup)
+ */
+void configure_system_status(const AppConfig& config);
+
+/**
+ * Start the background thread that runs the status collectors at their intervals
+ * (see "collectors" in config); without it each request collects what is due inline
+ */
+void start_status_collectors();
+
+void stop_status_collectors();
+
 #endif // SYSTEM_STATUS_H
 
@@ -0,0 +1,97 @@
+#ifndef THERMAL_STATS_H
+#define THERMAL_STATS_H
+
+#include "cpufreq_stats.h"
+#include <string>
+#include <vector>
+
+struct ThermalTripPoint {
+    std::string type;                 // passive, active, hot, critical
+    long long temp_millicelsius = 0;
+};
+
+struct ThermalZone {
+    std::string name;                 // thermal_zoneN
+    std::string type;                 // e.g. cpu-thermal, x86_pkg_temp
+    long long temp_millicelsius = 0;
+    bool ok = false;                  // Temperature read this pass
+    std::vector<ThermalTripPoint> trip_points;
+};
+
+struct CoolingDevice {
+    std::string name;                 // cooling_deviceN
+    std::string type;                 // e.g. cpufreq-cpu0, Processor, fan
+    long long cur_state = 0;
+    long long max_state = 0;
+};
+
+/**
+ * One hwmon input: temperature (C), fan speed (RPM), voltage (V) or power (W)
+ */
+struct HwmonSensor {
+    std::string chip;                 // hwmon "name" attribute
+    std::string label;                // *_label, or the input name (temp1, fan2, in0)
+    std::string kind;                 // "temp", "fan", "in", "power"
+    double value = 0;
+    bool ok = false;
+};
+
+/**
+ * Frequency state of one cpufreq policy used for throttling detection
+ */
+struct CpuFreqLimit {
+    std::string policy;               // policyN
+    long long cur_khz = 0;
+    long long scaling_max_khz = 0;
+    long long cpuinfo_max_khz = 0;
+    long long throttle_count = 0;     // x86 thermal_throttle events on the policy's CPUs
+    bool capped = false;              // scaling_max below hardware maximum, or new throttle events
+};
+
+/**
+ * Thermal zones, cooling devices and hwmon sensors under a sysfs root
+ * Sensor files are discovered once and kept open; each pass is one pread per file
+ */
+class ThermalCollector {
+public:
+    explicit ThermalCollector(const std::string& sys_root = host_sys_root());
+    ~ThermalCollector();
+
+    ThermalCollector(const ThermalCollector&) = delete;
+    ThermalCollector& operator=(const ThermalCollector&) = delete;
+
+    bool collect();
+
+    const std::vector<ThermalZone>& zones() const { return zones_; }
+    const std::vector<CoolingDevice>& cooling_devices() const { return cooling_; }
+    const std::vector<HwmonSensor>& sensors() const { return sensors_; }
+    const std::vector<CpuFreqLimit>& cpufreq_limits() const { return cpufreq_; }
+
+    /**
+     * True when a zone is near its passive trip point (or a CPU cooling device
+     * is active) while a policy's scaling_max_freq is held below the hardware
+     * maximum, or when the CPU reports new hardware thermal throttle events.
+     * A low instantaneous frequency alone is the governor idling, not a cap
+     */
+    bool throttling() const { return throttling_; }
+    const std::string& throttle_reason() const { return throttle_reason_; }
+
+private:
+    void discover(const std::string& sys_root);
+
+    std::vector<ThermalZone> zones_;
+    std::vector<int> zone_fds_;
+    std::vector<CoolingDevice> cooling_;
+    std::vector<int> cooling_fds_;
+    std::vector<HwmonSensor> sensors_;
+    std::vector<int> sensor_fds_;
+    std::vector<double> sensor_scale_;  // Raw sysfs unit -> reported unit
+    CpuFreqCollector cpufreq_collector_;
+    std::vector<CpuFreqLimit> cpufreq_;
+    std::vector<std::vector<int>> throttle_fds_;  // Per policy: cpuN/thermal_throttle/*_throttle_count
+    bool collected_once_;
+    bool throttling_;
+    std::string throttle_reason_;
+};
+
+#endif // THERMAL_STATS_H
@@ -0,0 +1,100 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "proc_reader.h"
+
+/**
+ * One CPU cache instance, shared by the CPUs in cpus
+ */
+struct CpuCache {
+    int level = 0;
+    std::string type;                 // Data, Instruction or Unified
+    long long size_bytes = 0;
+    int line_bytes = 0;
+    int ways = 0;
+    std::vector<int> cpus;            // shared_cpu_list
+};
+
+/**
+ * Placement of one online logical CPU
+ */
+struct CpuPlacement {
+    int cpu = 0;
+    int package = -1;                 // physical_package_id
+    int die = -1;
+    int cluster = -1;                 // Cluster (shared L2 on many ARM/x86 hybrids), -1 before Linux 5.16
+    int core = -1;
+    int node = -1;                    // NUMA node, -1 if the kernel has no node directory
+    std::vector<int> siblings;        // SMT threads of the same core, including cpu
+    std::vector<int> caches;          // Indexes into CpuTopology::caches, L1 first
+};
+
+/**
+ * One NUMA node from /sys/devices/system/node
+ */
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;
+    long long memory_total_bytes = 0;
+    std::vector<int> distances;       // To every node, in node order
+};
+
+/**
+ * CPU, cache and NUMA layout; it only changes with CPU hotplug, so it is read once
+ */
+struct CpuTopology {
+    std::vector<CpuPlacement> cpus;
+    std::vector<CpuCache> caches;
+    std::vector<NumaNode> nodes;
+    int packages = 0;
+    int cores = 0;                    // Distinct (package, die, cluster, core) tuples
+    int threads_per_core = 0;         // Largest SMT sibling count
+    bool smt_active = false;
+};
+
+/**
+ * Read topology from sysfs under sys_root
+ */
+CpuTopology read_cpu_topology(const std::string& sys_root = host_sys_root());
+
+/**
+ * Topology of this machine, read on first use and cached for the process lifetime
+ */
+const CpuTopology& get_cpu_topology();
+
+/**
+ * MemTotal / MemFree of one NUMA node
+ */
+struct NumaNodeMemory {
+    int node = 0;
+    long long total_bytes = 0;
+    long long free_bytes = 0;
+    long long file_pages_bytes = 0;   // FilePages: page cache that can be reclaimed
+    bool ok = false;
+};
+
+/**
+ * Parse node<N>/meminfo ("Node 0 MemTotal:  16318432 kB")
+ */
+bool parse_node_meminfo(const char* text, NumaNodeMemory& out);
+
+/**
+ * Per-node free memory from persistent node<N>/meminfo descriptors
+ */
+class NumaMemoryCollector {
+public:
+    explicit NumaMemoryCollector(const std::string& sys_root = host_sys_root());
+
+    bool collect();
+
+    const std::vector<NumaNodeMemory>& nodes() const { return nodes_; }
+
+private:
+    std::vector<NumaNodeMemory> nodes_;
+    std::vector<std::unique_ptr<ProcFileReader>> readers_;
+};
+
+#endif // TOPOLOGY_H
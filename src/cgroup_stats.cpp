@@ -0,0 +1,177 @@
+#include "cgroup_stats.h"
+#include "proc_reader.h"
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char* const kCgroupFileNames[] = {
+    "cpu.stat", "memory.current", "memory.max", "memory.stat", "io.stat", "pids.current"
+};
+
+// Value of "key N" in a flat keyed file such as cpu.stat or memory.stat
+static bool find_keyed_value(const char* text, const char* key, unsigned long long& out) {
+    size_t len = std::strlen(key);
+    const char* p = text;
+    while (p && *p) {
+        if (std::strncmp(p, key, len) == 0 && p[len] == ' ') {
+            out = std::strtoull(p + len + 1, nullptr, 10);
+            return true;
+        }
+        p = std::strchr(p, '\n');
+        if (p) ++p;
+    }
+    return false;
+}
+
+CgroupCollector::CgroupCollector(const std::vector<std::string>& paths,
+                                 const std::string& cgroup_root)
+    : cgroup_root_(cgroup_root), buffer_(4096), size_(0) {
+    cgroups_.resize(paths.size());
+    handles_.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        cgroups_[i].path = paths[i];
+        for (int& fd : handles_[i].fds) fd = -1;
+        open_cgroup(i);
+    }
+}
+
+CgroupCollector::~CgroupCollector() {
+    for (size_t i = 0; i < handles_.size(); ++i) {
+        close_cgroup(i);
+    }
+}
+
+bool CgroupCollector::open_cgroup(size_t index) {
+    Handle& handle = handles_[index];
+    std::string dir = cgroup_root_ + "/" + cgroups_[index].path;
+    handle.dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (handle.dir_fd < 0) {
+        return false;
+    }
+    // Controllers not enabled for this cgroup simply leave their fds at -1
+    for (int f = 0; f < kCgroupFileCount; ++f) {
+        handle.fds[f] = openat(handle.dir_fd, kCgroupFileNames[f], O_RDONLY | O_CLOEXEC);
+    }
+    handle.has_previous = false;
+    return true;
+}
+
+void CgroupCollector::close_cgroup(size_t index) {
+    Handle& handle = handles_[index];
+    for (int& fd : handle.fds) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    if (handle.dir_fd >= 0) {
+        close(handle.dir_fd);
+        handle.dir_fd = -1;
+    }
+}
+
+bool CgroupCollector::read_file(int fd) {
+    if (fd < 0 || !pread_all(fd, buffer_, size_)) {
+        buffer_[0] = '\0';
+        return false;
+    }
+    return true;
+}
+
+bool CgroupCollector::collect() {
+    bool any = false;
+    auto now = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < cgroups_.size(); ++i) {
+        CgroupStats& cg = cgroups_[i];
+        Handle& handle = handles_[i];
+
+        if (handle.dir_fd < 0 && !open_cgroup(i)) {
+            cg.available = false;
+            continue;
+        }
+        if (!read_file(handle.fds[kCpuStat])) {
+            // Files of a removed cgroup fail with ENODEV; the path may exist again
+            close_cgroup(i);
+            if (!open_cgroup(i) || !read_file(handle.fds[kCpuStat])) {
+                cg.available = false;
+                continue;
+            }
+        }
+        cg.available = true;
+        any = true;
+
+        CgroupStats prev = cg;
+        find_keyed_value(buffer_.data(), "usage_usec", cg.cpu_usage_usec);
+        find_keyed_value(buffer_.data(), "user_usec", cg.cpu_user_usec);
+        find_keyed_value(buffer_.data(), "system_usec", cg.cpu_system_usec);
+        find_keyed_value(buffer_.data(), "nr_throttled", cg.nr_throttled);
+        find_keyed_value(buffer_.data(), "throttled_usec", cg.throttled_usec);
+
+        if (read_file(handle.fds[kMemoryCurrent])) {
+            cg.memory_current_bytes = std::atoll(buffer_.data());
+        }
+        if (read_file(handle.fds[kMemoryMax])) {
+            cg.memory_max_bytes = std::strncmp(buffer_.data(), "max", 3) == 0 ? -1 : std::atoll(buffer_.data());
+        }
+        if (read_file(handle.fds[kMemoryStat])) {
+            unsigned long long value = 0;
+            if (find_keyed_value(buffer_.data(), "anon", value)) cg.memory_anon_bytes = (long long)value;
+            if (find_keyed_value(buffer_.data(), "file", value)) cg.memory_file_bytes = (long long)value;
+            if (find_keyed_value(buffer_.data(), "kernel", value)) {
+                cg.memory_kernel_bytes = (long long)value;
+            } else {
+                // Kernels before 5.18 have no aggregate "kernel" entry
+                unsigned long long stack = 0, slab = 0;
+                find_keyed_value(buffer_.data(), "kernel_stack", stack);
+                find_keyed_value(buffer_.data(), "slab", slab);
+                cg.memory_kernel_bytes = (long long)(stack + slab);
+            }
+            find_keyed_value(buffer_.data(), "pgmajfault", cg.pgmajfault);
+        }
+
+        // io.stat: "MAJ:MIN rbytes=N wbytes=N rios=N wios=N dbytes=N dios=N" per device
+        cg.io_read_bytes = cg.io_write_bytes = cg.io_read_ios = cg.io_write_ios = 0;
+        if (read_file(handle.fds[kIoStat])) {
+            const char* p = buffer_.data();
+            while (*p) {
+                const char* eq = std::strchr(p, '=');
+                if (!eq) break;
+                const char* key = eq;
+                while (key > p && key[-1] != ' ' && key[-1] != '\n') --key;
+                unsigned long long value = std::strtoull(eq + 1, nullptr, 10);
+                size_t key_len = eq - key;
+                if (key_len == 6 && std::strncmp(key, "rbytes", 6) == 0) cg.io_read_bytes += value;
+                else if (key_len == 6 && std::strncmp(key, "wbytes", 6) == 0) cg.io_write_bytes += value;
+                else if (key_len == 4 && std::strncmp(key, "rios", 4) == 0) cg.io_read_ios += value;
+                else if (key_len == 4 && std::strncmp(key, "wios", 4) == 0) cg.io_write_ios += value;
+                p = eq + 1;
+            }
+        }
+
+        if (read_file(handle.fds[kPidsCurrent])) {
+            cg.pids_current = std::atoll(buffer_.data());
+        }
+
+        double elapsed = std::chrono::duration<double>(now - handle.last_sample).count();
+        if (handle.has_previous && elapsed > 0 && cg.cpu_usage_usec >= prev.cpu_usage_usec) {
+            double elapsed_usec = elapsed * 1e6;
+            cg.cpu_percent = (cg.cpu_usage_usec - prev.cpu_usage_usec) / elapsed_usec * 100.0;
+            cg.throttled_percent = (cg.throttled_usec - prev.throttled_usec) / elapsed_usec * 100.0;
+            // io.stat sums drop when a device goes away; report 0 rather than wrap
+            auto rate = [elapsed](unsigned long long cur, unsigned long long old) {
+                return cur >= old ? (cur - old) / elapsed : 0.0;
+            };
+            cg.io_read_bytes_per_sec = rate(cg.io_read_bytes, prev.io_read_bytes);
+            cg.io_write_bytes_per_sec = rate(cg.io_write_bytes, prev.io_write_bytes);
+            cg.io_read_iops = rate(cg.io_read_ios, prev.io_read_ios);
+            cg.io_write_iops = rate(cg.io_write_ios, prev.io_write_ios);
+        } else {
+            cg.cpu_percent = cg.throttled_percent = -1;
+            cg.io_read_bytes_per_sec = cg.io_write_bytes_per_sec = -1;
+            cg.io_read_iops = cg.io_write_iops = -1;
+        }
+        handle.has_previous = true;
+        handle.last_sample = now;
+    }
+    return any;
+}
@@ -0,0 +1,224 @@
+#include "collector_registry.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <time.h>
+
+// Auto-slowing never stretches an interval beyond this multiple of the configured one
+static const int kMaxSlowdown = 64;
+
+static double thread_cpu_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+CollectorRegistry::CollectorRegistry(double cpu_budget_percent)
+    : cpu_budget_percent_(cpu_budget_percent), idle_hold_ms_(0), idle_interval_ms_(0),
+      stop_(false), wake_(false), last_demand_(std::chrono::steady_clock::now()) {
+}
+
+CollectorRegistry::~CollectorRegistry() {
+    stop();
+}
+
+void CollectorRegistry::add(std::unique_ptr<StatusCollector> collector) {
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->stats.name = collector->name();
+    entry->stats.interval_ms = collector->interval_ms();
+    entry->stats.effective_interval_ms = collector->interval_ms();
+    entry->stats.cpu_budget_percent = collector->cpu_budget_percent() >= 0 ? collector->cpu_budget_percent()
+                                                                            : cpu_budget_percent_;
+    entry->collector = std::move(collector);
+    entries_.push_back(std::move(entry));
+}
+
+void CollectorRegistry::set_idle_backoff(int hold_ms, int idle_interval_ms) {
+    idle_hold_ms_ = hold_ms;
+    idle_interval_ms_ = idle_interval_ms;
+}
+
+void CollectorRegistry::start() {
+    std::lock_guard<std::mutex> lock(thread_mutex_);
+    if (thread_.joinable()) {
+        return;
+    }
+    stop_ = false;
+    last_demand_ = std::chrono::steady_clock::now();
+    thread_ = std::thread(&CollectorRegistry::loop, this);
+}
+
+void CollectorRegistry::stop() {
+    {
+        std::lock_guard<std::mutex> lock(thread_mutex_);
+        if (!thread_.joinable()) {
+            return;
+        }
+        stop_ = true;
+    }
+    thread_cv_.notify_all();
+    thread_.join();
+}
+
+// Caller holds entry.collect_mutex
+void CollectorRegistry::run(Entry& entry) {
+    auto wall_start = std::chrono::steady_clock::now();
+    double cpu_start = thread_cpu_us();
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(2);
+    entry.collector->collect(json);
+    double cpu_us = thread_cpu_us() - cpu_start;
+    auto wall_end = std::chrono::steady_clock::now();
+    auto fragment = std::make_shared<const std::string>(json.str());
+
+    std::lock_guard<std::mutex> lock(entry.fragment_mutex);
+    entry.fragment = fragment;
+    entry.last_run = wall_end;
+    CollectorStats& stats = entry.stats;
+    stats.runs++;
+    stats.last_cpu_us = cpu_us;
+    stats.last_wall_us = std::chrono::duration<double, std::micro>(wall_end - wall_start).count();
+    stats.avg_cpu_us = stats.runs == 1 ? cpu_us : 0.8 * stats.avg_cpu_us + 0.2 * cpu_us;
+
+    if (stats.interval_ms <= 0) {
+        // Collect-once collectors are never rescheduled
+        stats.cpu_percent = 0;
+        entry.next_due = std::chrono::steady_clock::time_point::max();
+        return;
+    }
+
+    int effective = stats.effective_interval_ms;
+    double budget = stats.cpu_budget_percent;
+    double cpu_percent = stats.avg_cpu_us / (effective * 1000.0) * 100.0;
+    if (budget > 0 && cpu_percent > budget &&
+        effective < stats.interval_ms * kMaxSlowdown) {
+        effective *= 2;
+        std::ostringstream message;
+        message << "Collector " << stats.name << " over CPU budget (" << std::fixed << std::setprecision(3)
+                << cpu_percent << "% > " << budget << "%), interval now " << effective << " ms";
+        std::cout << message.str() << std::endl;
+    } else if (effective > stats.interval_ms &&
+               stats.avg_cpu_us / (effective / 2 * 1000.0) * 100.0 < budget / 2) {
+        // Speed back up only when the shorter interval would still use under half the budget
+        effective = std::max(stats.interval_ms, effective / 2);
+        std::cout << "Collector " << stats.name << " back within CPU budget, interval now " << effective << " ms" << std::endl;
+    }
+    stats.effective_interval_ms = effective;
+    stats.cpu_percent = stats.avg_cpu_us / (effective * 1000.0) * 100.0;
+    // Scheduled from the start of this run so the cadence does not drift by the collection time
+    entry.next_due = wall_start + std::chrono::milliseconds(effective);
+}
+
+// Caller holds thread_mutex_
+bool CollectorRegistry::is_idle(std::chrono::steady_clock::time_point now) const {
+    return idle_interval_ms_ > 0 && now - last_demand_ >= std::chrono::milliseconds(idle_hold_ms_);
+}
+
+// Caller holds entry.fragment_mutex
+std::chrono::steady_clock::time_point CollectorRegistry::idle_due(const Entry& entry, bool idle) const {
+    if (!idle || !entry.fragment || entry.next_due == std::chrono::steady_clock::time_point::max()) {
+        return entry.next_due;
+    }
+    return std::max(entry.next_due, entry.last_run + std::chrono::milliseconds(idle_interval_ms_));
+}
+
+void CollectorRegistry::loop() {
+    std::unique_lock<std::mutex> lock(thread_mutex_);
+    while (!stop_) {
+        wake_ = false;
+        auto now = std::chrono::steady_clock::now();
+        bool idle = is_idle(now);
+        lock.unlock();
+
+        auto next = std::chrono::steady_clock::time_point::max();
+        for (auto& entry : entries_) {
+            std::chrono::steady_clock::time_point due;
+            {
+                std::lock_guard<std::mutex> fragment_lock(entry->fragment_mutex);
+                due = idle_due(*entry, idle);
+            }
+            if (due <= now) {
+                {
+                    std::lock_guard<std::mutex> collect_lock(entry->collect_mutex);
+                    run(*entry);
+                }
+                std::lock_guard<std::mutex> fragment_lock(entry->fragment_mutex);
+                due = idle_due(*entry, idle);
+            }
+            next = std::min(next, due);
+        }
+
+        lock.lock();
+        // Going idle stretches the schedule; re-plan once the hold runs out
+        if (!idle && idle_interval_ms_ > 0) {
+            next = std::min(next, last_demand_ + std::chrono::milliseconds(idle_hold_ms_));
+        }
+        if (next == std::chrono::steady_clock::time_point::max()) {
+            thread_cv_.wait(lock, [this] { return stop_ || wake_; });
+        } else {
+            thread_cv_.wait_until(lock, next, [this] { return stop_ || wake_; });
+        }
+    }
+}
+
+std::vector<std::shared_ptr<const std::string>> CollectorRegistry::snapshot() {
+    auto now = std::chrono::steady_clock::now();
+    bool scheduled;
+    bool was_idle;
+    {
+        std::lock_guard<std::mutex> lock(thread_mutex_);
+        scheduled = thread_.joinable();
+        was_idle = is_idle(now);
+        last_demand_ = now;
+        if (was_idle) wake_ = true;
+    }
+    if (was_idle) {
+        // Back to the configured intervals
+        thread_cv_.notify_all();
+    }
+    // Unscheduled, or stretched while idle: refresh overdue collectors for this caller
+    bool refresh_due = !scheduled || was_idle;
+
+    std::vector<std::shared_ptr<const std::string>> fragments;
+    fragments.reserve(entries_.size());
+    for (auto& entry : entries_) {
+        std::shared_ptr<const std::string> fragment;
+        std::chrono::steady_clock::time_point due;
+        {
+            std::lock_guard<std::mutex> lock(entry->fragment_mutex);
+            fragment = entry->fragment;
+            due = entry->next_due;
+        }
+        // Run inline if nothing was collected yet, or if it is overdue and nobody else will run it
+        if (!fragment || (refresh_due && due <= now)) {
+            std::lock_guard<std::mutex> collect_lock(entry->collect_mutex);
+            {
+                std::lock_guard<std::mutex> lock(entry->fragment_mutex);
+                fragment = entry->fragment;
+                due = entry->next_due;
+            }
+            if (!fragment || (refresh_due && due <= now)) {
+                run(*entry);
+                std::lock_guard<std::mutex> lock(entry->fragment_mutex);
+                fragment = entry->fragment;
+            }
+        }
+        fragments.push_back(fragment);
+    }
+    return fragments;
+}
+
+std::vector<CollectorStats> CollectorRegistry::stats() const {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<CollectorStats> result;
+    result.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        std::lock_guard<std::mutex> lock(entry->fragment_mutex);
+        CollectorStats stats = entry->stats;
+        if (entry->fragment) {
+            stats.age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - entry->last_run).count();
+        }
+        result.push_back(stats);
+    }
+    return result;
+}
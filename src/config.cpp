@@ -57,6 +57,85 @@ static int extract_json_int(const std::string& json, const std::string& key, int
     }
 }
 
+// Helper function to extract JSON floating-point value
+static double extract_json_double(const std::string& json, const std::string& key, double default_value = 0) {
+    std::string value = extract_json_string(json, key);
+    if (value.empty()) return default_value;
+    
+    try {
+        return std::stod(value);
+    } catch (...) {
+        return default_value;
+    }
+}
+
+// Helper function to extract JSON boolean value
+static bool extract_json_bool(const std::string& json, const std::string& key, bool default_value = false) {
+    std::string value = extract_json_string(json, key);
+    if (value == "true" || value == "1") return true;
+    if (value == "false" || value == "0") return false;
+    return default_value;
+}
+
+// Helper function to extract JSON array of strings
+static std::vector<std::string> extract_json_string_array(const std::string& json, const std::string& key) {
+    std::vector<std::string> result;
+    std::string search_key = "\"" + key + "\"";
+    size_t pos = json.find(search_key);
+    if (pos == std::string::npos) return result;
+    
+    pos = json.find("[", pos);
+    if (pos == std::string::npos) return result;
+    
+    size_t end = json.find("]", pos);
+    if (end == std::string::npos) return result;
+    
+    size_t i = pos + 1;
+    while (i < end) {
+        size_t quote_start = json.find("\"", i);
+        if (quote_start == std::string::npos || quote_start >= end) break;
+        size_t quote_end = quote_start + 1;
+        while (quote_end < end && json[quote_end] != '"') {
+            if (json[quote_end] == '\\') quote_end++;
+            quote_end++;
+        }
+        if (quote_end >= end) break;
+        result.push_back(json.substr(quote_start + 1, quote_end - quote_start - 1));
+        i = quote_end + 1;
+    }
+    
+    return result;
+}
+
+// Helper function to extract a JSON array of objects (each returned as its "{...}" text)
+static std::vector<std::string> extract_json_object_array(const std::string& json, const std::string& key) {
+    std::vector<std::string> result;
+    std::string search_key = "\"" + key + "\"";
+    size_t pos = json.find(search_key);
+    if (pos == std::string::npos) return result;
+    
+    pos = json.find("[", pos);
+    if (pos == std::string::npos) return result;
+    
+    int brace_count = 0;
+    size_t start = 0;
+    for (size_t i = pos + 1; i < json.length(); i++) {
+        if (json[i] == '{') {
+            if (brace_count == 0) start = i;
+            brace_count++;
+        } else if (json[i] == '}') {
+            brace_count--;
+            if (brace_count == 0) {
+                result.push_back(json.substr(start, i - start + 1));
+            }
+        } else if (json[i] == ']' && brace_count == 0) {
+            break;
+        }
+    }
+    
+    return result;
+}
+
 // Helper function to extract nested JSON object
 static std::string extract_json_object(const std::string& json, const std::string& key) {
     std::string search_key = "\"" + key + "\"";
@@ -82,12 +161,49 @@ static std::string extract_json_object(const std::string& json, const std::strin
     return "";
 }
 
+// Helper function to extract a flat JSON object of numbers ({"name": 1.5, ...}) as key/value pairs
+static std::vector<std::pair<std::string, double>> extract_json_number_map(const std::string& json, const std::string& key) {
+    std::vector<std::pair<std::string, double>> result;
+    std::string object = extract_json_object(json, key);
+    size_t i = 1;
+    while (i < object.length()) {
+        size_t quote_start = object.find("\"", i);
+        if (quote_start == std::string::npos) break;
+        size_t quote_end = object.find("\"", quote_start + 1);
+        if (quote_end == std::string::npos) break;
+        size_t colon = object.find(":", quote_end);
+        if (colon == std::string::npos) break;
+        
+        char* end = nullptr;
+        double value = std::strtod(object.c_str() + colon + 1, &end);
+        if (end != object.c_str() + colon + 1) {
+            result.push_back(std::make_pair(object.substr(quote_start + 1, quote_end - quote_start - 1), value));
+        }
+        i = end - object.c_str();
+        if (i <= colon) i = colon + 1;
+    }
+    
+    return result;
+}
+
+// Same for integers ({"name": 1000, ...})
+static std::vector<std::pair<std::string, int>> extract_json_int_map(const std::string& json, const std::string& key) {
+    std::vector<std::pair<std::string, int>> result;
+    for (const auto& entry : extract_json_number_map(json, key)) {
+        result.push_back(std::make_pair(entry.first, (int)entry.second));
+    }
+    return result;
+}
+
 AppConfig get_default_config() {
     AppConfig config;
     
     // Server defaults
     config.server.port = 8080;
     config.server.host = "0.0.0.0";
+    config.server.unix_socket = "";
+    config.server.unix_socket_mode = 0660;
+    config.server.unix_socket_group = "";
     
     // Authentication defaults
     config.authentication.username = "cvedix";
@@ -100,6 +216,54 @@ AppConfig get_default_config() {
     // Logging defaults
     config.logging.level = "info";
     
+    // Background sampler defaults
+    config.sampler.interval_ms = 1000;
+    config.sampler.idle_interval_ms = 10000;
+    config.sampler.demand_hold_ms = 30000;
+    config.sampler.cpu_change_percent = 10.0;
+    config.sampler.memory_change_percent = 5.0;
+    config.sampler.temperature_change_c = 3.0;
+    config.sampler.psi_some_percent = 10.0;
+    
+    // StatsD push exporter defaults (disabled)
+    config.statsd.enabled = false;
+    config.statsd.host = "127.0.0.1";
+    config.statsd.port = 8125;
+    config.statsd.interval_ms = 10000;
+    config.statsd.prefix = "metrics_monitor";
+    config.statsd.max_packet_bytes = 1432; // 1500 MTU - IP/UDP headers, with margin
+    
+    // Shared-memory snapshot defaults (disabled)
+    config.shm.enabled = false;
+    config.shm.name = "/metrics_monitor";
+    
+    // Disk I/O collector defaults
+    config.disk_io.include_partitions = false;
+    
+    // PSI: no cgroups or triggers unless configured
+    config.psi.cgroups.clear();
+    config.psi.triggers.clear();
+    
+    // cgroup v2 accounting: nothing unless configured
+    config.cgroup_stats.paths.clear();
+    
+    // Hardware performance counters (disabled)
+    config.perf.enabled = false;
+    config.perf.system_wide = true;
+    config.perf.cgroups.clear();
+    
+    // Status collectors: built-in intervals, each may use up to 1% of one core
+    config.collectors.cpu_budget_percent = 1.0;
+    config.collectors.intervals_ms.clear();
+    
+    // Host procfs/sysfs/root: the environment or the standard locations
+    config.host_paths.proc = "";
+    config.host_paths.sys = "";
+    config.host_paths.rootfs = "";
+    
+    // No instance-to-process bindings unless configured
+    config.instance_bindings.clear();
+    
     return config;
 }
 
@@ -135,9 +299,36 @@ AppConfig load_config(const std::string& config_path) {
         if (port > 0 && port < 65536) {
             config.server.port = port;
         }
-        if (!host.empty()) {
+        if (host.rfind("unix:", 0) == 0) {
+            // "unix:/path" replaces the TCP listener with a Unix domain socket
+            config.server.unix_socket = host.substr(5);
+            config.server.host = "";
+        } else if (!host.empty()) {
             config.server.host = host;
         }
+        
+        // "unix_socket" adds a Unix domain socket listener alongside host:port
+        std::string unix_socket = extract_json_string(server_json, "unix_socket");
+        if (unix_socket.rfind("unix:", 0) == 0) {
+            unix_socket = unix_socket.substr(5);
+        }
+        if (!unix_socket.empty()) {
+            config.server.unix_socket = unix_socket;
+        }
+        
+        // "unix_socket_mode" is an octal string ("0660"); only owner/group/other rw bits are kept
+        std::string mode = extract_json_string(server_json, "unix_socket_mode");
+        if (!mode.empty()) {
+            char* end = nullptr;
+            long bits = std::strtol(mode.c_str(), &end, 8);
+            if (end != mode.c_str() && *end == '\0' && bits >= 0 && bits <= 0777) {
+                config.server.unix_socket_mode = static_cast<int>(bits) & 0666;
+            }
+        }
+        std::string group = extract_json_string(server_json, "unix_socket_group");
+        if (!group.empty()) {
+            config.server.unix_socket_group = group;
+        }
     }
     
     // Parse authentication config
@@ -177,6 +368,124 @@ AppConfig load_config(const std::string& config_path) {
         }
     }
     
+    // Parse sampler config
+    std::string sampler_json = extract_json_object(content, "sampler");
+    if (!sampler_json.empty()) {
+        int interval_ms = extract_json_int(sampler_json, "interval_ms", config.sampler.interval_ms);
+        if (interval_ms >= 10) {
+            config.sampler.interval_ms = interval_ms;
+        }
+        config.sampler.idle_interval_ms = extract_json_int(sampler_json, "idle_interval_ms", config.sampler.idle_interval_ms);
+        config.sampler.demand_hold_ms = extract_json_int(sampler_json, "demand_hold_ms", config.sampler.demand_hold_ms);
+        config.sampler.cpu_change_percent = extract_json_double(sampler_json, "cpu_change_percent",
+                                                                config.sampler.cpu_change_percent);
+        config.sampler.memory_change_percent = extract_json_double(sampler_json, "memory_change_percent",
+                                                                   config.sampler.memory_change_percent);
+        config.sampler.temperature_change_c = extract_json_double(sampler_json, "temperature_change_c",
+                                                                  config.sampler.temperature_change_c);
+        config.sampler.psi_some_percent = extract_json_double(sampler_json, "psi_some_percent",
+                                                              config.sampler.psi_some_percent);
+    }
+    
+    // Parse StatsD exporter config
+    std::string statsd_json = extract_json_object(content, "statsd");
+    if (!statsd_json.empty()) {
+        config.statsd.enabled = extract_json_bool(statsd_json, "enabled", config.statsd.enabled);
+        
+        std::string host = extract_json_string(statsd_json, "host");
+        if (!host.empty()) {
+            config.statsd.host = host;
+        }
+        
+        int port = extract_json_int(statsd_json, "port", config.statsd.port);
+        if (port > 0 && port < 65536) {
+            config.statsd.port = port;
+        }
+        
+        int interval_ms = extract_json_int(statsd_json, "interval_ms", config.statsd.interval_ms);
+        if (interval_ms >= 100) {
+            config.statsd.interval_ms = interval_ms;
+        }
+        
+        std::string prefix = extract_json_string(statsd_json, "prefix");
+        if (!prefix.empty()) {
+            config.statsd.prefix = prefix;
+        }
+        
+        int max_packet = extract_json_int(statsd_json, "max_packet_bytes", config.statsd.max_packet_bytes);
+        if (max_packet >= 512 && max_packet <= 65000) {
+            config.statsd.max_packet_bytes = max_packet;
+        }
+    }
+    
+    // Parse shared-memory snapshot config
+    std::string shm_json = extract_json_object(content, "shm");
+    if (!shm_json.empty()) {
+        config.shm.enabled = extract_json_bool(shm_json, "enabled", config.shm.enabled);
+        
+        std::string name = extract_json_string(shm_json, "name");
+        if (!name.empty()) {
+            config.shm.name = name[0] == '/' ? name : "/" + name;
+        }
+    }
+    
+    // Parse disk I/O collector config
+    std::string disk_io_json = extract_json_object(content, "disk_io");
+    if (!disk_io_json.empty()) {
+        config.disk_io.include_partitions = extract_json_bool(disk_io_json, "include_partitions",
+                                                              config.disk_io.include_partitions);
+    }
+    
+    // Parse PSI config
+    std::string psi_json = extract_json_object(content, "psi");
+    if (!psi_json.empty()) {
+        config.psi.cgroups = extract_json_string_array(psi_json, "cgroups");
+        config.psi.triggers = extract_json_string_array(psi_json, "triggers");
+    }
+    
+    // Parse cgroup v2 accounting paths
+    std::string cgroup_stats_json = extract_json_object(content, "cgroup_stats");
+    if (!cgroup_stats_json.empty()) {
+        config.cgroup_stats.paths = extract_json_string_array(cgroup_stats_json, "paths");
+    }
+    
+    // Parse perf counter config
+    std::string perf_json = extract_json_object(content, "perf");
+    if (!perf_json.empty()) {
+        config.perf.enabled = extract_json_bool(perf_json, "enabled", config.perf.enabled);
+        config.perf.system_wide = extract_json_bool(perf_json, "system_wide", config.perf.system_wide);
+        config.perf.cgroups = extract_json_string_array(perf_json, "cgroups");
+    }
+    
+    // Parse status collector scheduling
+    std::string collectors_json = extract_json_object(content, "collectors");
+    if (!collectors_json.empty()) {
+        config.collectors.cpu_budget_percent = extract_json_double(collectors_json, "cpu_budget_percent",
+                                                                   config.collectors.cpu_budget_percent);
+        config.collectors.intervals_ms = extract_json_int_map(collectors_json, "intervals_ms");
+        config.collectors.cpu_budgets_percent = extract_json_number_map(collectors_json, "cpu_budgets_percent");
+    }
+    
+    // Parse host filesystem roots (container sidecar, recorded fixtures)
+    std::string host_paths_json = extract_json_object(content, "host_paths");
+    if (!host_paths_json.empty()) {
+        config.host_paths.proc = extract_json_string(host_paths_json, "proc");
+        config.host_paths.sys = extract_json_string(host_paths_json, "sys");
+        config.host_paths.rootfs = extract_json_string(host_paths_json, "rootfs");
+    }
+    
+    // Parse instance process bindings
+    for (const auto& binding_json : extract_json_object_array(content, "instance_bindings")) {
+        InstanceBinding binding;
+        binding.id = extract_json_string(binding_json, "id");
+        binding.pidfile = extract_json_string(binding_json, "pidfile");
+        binding.cgroup = extract_json_string(binding_json, "cgroup");
+        binding.cmdline = extract_json_string(binding_json, "cmdline");
+        if (!binding.id.empty()) {
+            config.instance_bindings.push_back(binding);
+        }
+    }
+    
     return config;
 }
 
@@ -0,0 +1,134 @@
+#include "cpufreq_stats.h"
+#include "proc_reader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    const char* p = list.c_str();
+    while (*p) {
+        char* end = nullptr;
+        long first = std::strtol(p, &end, 10);
+        if (end == p) {
+            ++p;
+            continue;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back((int)cpu);
+        }
+        while (*p == ',' || *p == ' ' || *p == '\n') ++p;
+    }
+    return cpus;
+}
+
+CpuFreqCollector::CpuFreqCollector(const std::string& sys_root)
+    : settings_generation_(0) {
+    std::string cpufreq_dir = sys_root + "/devices/system/cpu/cpufreq";
+    for (const auto& name : list_numbered_entries(cpufreq_dir, "policy")) {
+        std::string base = cpufreq_dir + "/" + name;
+        int cur_fd = open_attribute(base + "/scaling_cur_freq");
+        if (cur_fd < 0) {
+            // Some drivers only expose cpuinfo_cur_freq (root-readable)
+            cur_fd = open_attribute(base + "/cpuinfo_cur_freq");
+        }
+        if (cur_fd < 0) continue;
+
+        CpuFreqPolicy policy;
+        policy.name = name;
+        policy.cpus = parse_cpu_list(read_sysfs_string(base + "/related_cpus"));
+        if (policy.cpus.empty()) {
+            policy.cpus = parse_cpu_list(read_sysfs_string(base + "/affected_cpus"));
+        }
+        if (policy.cpus.empty()) {
+            // policyN is named after its first CPU
+            policy.cpus.push_back(std::atoi(name.c_str() + 6));
+        }
+        policy.cpuinfo_min_khz = std::atoll(read_sysfs_string(base + "/cpuinfo_min_freq").c_str());
+        policy.cpuinfo_max_khz = std::atoll(read_sysfs_string(base + "/cpuinfo_max_freq").c_str());
+        policies_.push_back(policy);
+        cur_fds_.push_back(cur_fd);
+
+        SettingFile governor, min_freq, max_freq;
+        governor.fd = open_attribute(base + "/scaling_governor");
+        min_freq.fd = open_attribute(base + "/scaling_min_freq");
+        max_freq.fd = open_attribute(base + "/scaling_max_freq");
+        governor_files_.push_back(governor);
+        min_files_.push_back(min_freq);
+        max_files_.push_back(max_freq);
+    }
+
+    // CPUs in one policy share a clock, so each core maps to its policy's reading
+    for (size_t i = 0; i < policies_.size(); ++i) {
+        for (int cpu : policies_[i].cpus) {
+            CpuCoreFreq core;
+            core.cpu = cpu;
+            core.policy = (int)i;
+            cores_.push_back(core);
+        }
+    }
+    std::sort(cores_.begin(), cores_.end(),
+              [](const CpuCoreFreq& a, const CpuCoreFreq& b) { return a.cpu < b.cpu; });
+}
+
+CpuFreqCollector::~CpuFreqCollector() {
+    for (int fd : cur_fds_) close(fd);
+    for (auto* files : {&governor_files_, &min_files_, &max_files_}) {
+        for (auto& file : *files) {
+            if (file.fd >= 0) close(file.fd);
+        }
+    }
+}
+
+// Returns true if the attribute's bytes differ from the cached copy
+bool CpuFreqCollector::refresh_setting(SettingFile& file) {
+    if (file.fd < 0) {
+        return false;
+    }
+    char buf[64];
+    ssize_t n = pread(file.fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+        return false;
+    }
+    while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' ')) --n;
+    if (file.raw.size() == (size_t)n && file.raw.compare(0, n, buf, n) == 0) {
+        return false;
+    }
+    file.raw.assign(buf, n);
+    return true;
+}
+
+bool CpuFreqCollector::collect() {
+    for (size_t i = 0; i < policies_.size(); ++i) {
+        CpuFreqPolicy& policy = policies_[i];
+        read_fd_long_long(cur_fds_[i], policy.cur_khz);
+
+        bool changed = false;
+        if (refresh_setting(governor_files_[i])) {
+            policy.governor = governor_files_[i].raw;
+            changed = true;
+        }
+        if (refresh_setting(min_files_[i])) {
+            policy.scaling_min_khz = std::atoll(min_files_[i].raw.c_str());
+            changed = true;
+        }
+        if (refresh_setting(max_files_[i])) {
+            policy.scaling_max_khz = std::atoll(max_files_[i].raw.c_str());
+            changed = true;
+        }
+        if (changed) {
+            settings_generation_++;
+        }
+    }
+
+    for (auto& core : cores_) {
+        core.cur_khz = policies_[core.policy].cur_khz;
+    }
+    return !policies_.empty();
+}
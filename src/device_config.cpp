@@ -1,24 +1,80 @@
 #include "device_config.h"
 #include "json_utils.h"
+#include "proc_reader.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cstring>
+#include <cerrno>
 #include <cstdlib>
 #include <cstdio>
-#include <sys/stat.h>
 #include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
 
 // Build date macros (set by compiler)
 #ifndef BUILD_DATE
 #define BUILD_DATE __DATE__ " " __TIME__
 #endif
 
-static DeviceInfo g_device_info;
-static bool g_config_loaded = false;
-static std::vector<std::string> g_device_instances;
-static std::string g_cached_system_uuid; // Cache system UUID (doesn't change)
-static time_t g_last_instances_file_mtime = 0; // Track file modification time for instances
+// Published state; replaced wholesale by publish_device_state(), never modified in place.
+// std::atomic_load/atomic_store on a shared_ptr lock a mutex from a libstdc++ pool, so readers only
+// use them when g_device_state_version shows the state changed (see get_device_state())
+static std::shared_ptr<const DeviceState> g_device_state;
+// Bumped after every publish; 0 until the first load
+static std::atomic<unsigned long long> g_device_state_version{0};
+// Serializes writers (load, reload, POST) so that read-modify-publish sequences do not lose updates
+static std::mutex g_state_write_mutex;
+// The published state has updates that no save_device_config() write has attempted yet;
+// guarded by g_state_write_mutex. A reload from the file would silently drop them
+static bool g_state_dirty = false;
+
+// Registration file written by POST; the current directory (development) takes priority over /etc (production)
+static const char* const kRegisteredConfigName = "device_registered.json";
+static const char* const kRegisteredConfigDirs[] = {".", "/etc"};
+
+// Instance add/remove operations since the last full write of device_registered.json,
+// one "+<id>" or "-<id>" line each, kept next to the registration file they amend
+static const char* const kInstanceJournalName = "device_instances.journal";
+// The journal is compacted into device_registered.json once it has more entries
+// than this and than there are instances
+static const size_t kJournalCompactMinEntries = 1024;
+
+// Serializes journal appends and full writes (which drop the journal); taken before g_state_write_mutex
+static std::mutex g_journal_mutex;
+static std::atomic<size_t> g_journal_entries(0);
+// "journal_generation" of the registration file last loaded or written; bumped by every
+// full write. The journal starts with "#<generation>" of the file it amends, so a
+// journal that outlived a crash between the rename and its unlink is recognized as stale
+static std::atomic<unsigned long long> g_config_generation(0);
+
+// POSTs that call save_device_config() within this window share one durable write
+static const int kSaveCoalesceWindowMs = 20;
+
+// Group commit state: generations are handed out per save request; one caller at a
+// time writes the latest state on behalf of every generation requested so far
+static std::mutex g_save_mutex;
+static std::condition_variable g_save_cv;
+static unsigned long long g_save_requested = 0;   // Last generation handed out
+static unsigned long long g_save_attempted = 0;   // Last generation covered by a finished write
+static unsigned long long g_save_durable = 0;     // Last generation covered by a successful write
+static bool g_save_writing = false;
+
+// Registration file this process last renamed into place, so the watcher can tell its
+// own writes from external edits; guarded by g_journal_mutex
+static std::string g_written_config_dir;
+static struct stat g_written_config_stat;
 
 // Default device configuration
 static DeviceInfo get_default_device_info() {
@@ -42,14 +98,9 @@ static DeviceInfo get_default_device_info() {
     return info;
 }
 
-std::string read_system_uuid() {
-    // Return cached value if available (system UUID doesn't change)
-    if (!g_cached_system_uuid.empty()) {
-        return g_cached_system_uuid;
-    }
-    
+static std::string detect_system_uuid() {
     // Try to read from /etc/machine-id first (systemd) - fast
-    std::ifstream machine_id_file("/etc/machine-id");
+    std::ifstream machine_id_file(host_rootfs() + "/etc/machine-id");
     if (machine_id_file.is_open()) {
         std::string machine_id;
         std::getline(machine_id_file, machine_id);
@@ -62,22 +113,19 @@ std::string read_system_uuid() {
                                   machine_id.substr(12, 4) + "-" +
                                   machine_id.substr(16, 4) + "-" +
                                   machine_id.substr(20, 12);
-                g_cached_system_uuid = uuid;
                 return uuid;
             }
-            g_cached_system_uuid = machine_id;
             return machine_id;
         }
     }
     
     // Try /sys/class/dmi/id/product_uuid (DMI) - fast, no command execution
-    std::ifstream dmi_file("/sys/class/dmi/id/product_uuid");
+    std::ifstream dmi_file(host_sys_root() + "/class/dmi/id/product_uuid");
     if (dmi_file.is_open()) {
         std::string uuid;
         std::getline(dmi_file, uuid);
         dmi_file.close();
         if (!uuid.empty() && uuid != "00000000-0000-0000-0000-000000000000") {
-            g_cached_system_uuid = uuid;
             return uuid;
         }
     }
@@ -94,7 +142,6 @@ std::string read_system_uuid() {
                 uuid.pop_back();
             }
             if (!uuid.empty() && uuid != "Not Specified" && uuid != "00000000-0000-0000-0000-000000000000") {
-                g_cached_system_uuid = uuid;
                 return uuid;
             }
         } else {
@@ -102,9 +149,14 @@ std::string read_system_uuid() {
         }
     }
     
-    // Last resort: return default and cache it
-    g_cached_system_uuid = "0fca8dd9-68be-26d9-3cf3-aa4625bac670";
-    return g_cached_system_uuid;
+    // Last resort: return default
+    return "0fca8dd9-68be-26d9-3cf3-aa4625bac670";
+}
+
+std::string read_system_uuid() {
+    // Detected once (system UUID doesn't change); the static initialization is thread-safe
+    static const std::string uuid = detect_system_uuid();
+    return uuid;
 }
 
 std::string get_build_date() {
@@ -221,165 +273,325 @@ static std::vector<std::string> extract_json_array(const std::string& json, cons
     return result;
 }
 
-void load_device_config() {
-    if (g_config_loaded) {
-        return;
+// Read the first registration file that exists; dir receives its directory
+static bool read_registered_config(std::string& content, std::string& dir) {
+    for (const char* candidate : kRegisteredConfigDirs) {
+        std::ifstream saved_config(std::string(candidate) + "/" + kRegisteredConfigName);
+        if (saved_config.is_open()) {
+            content.assign((std::istreambuf_iterator<char>(saved_config)),
+                           std::istreambuf_iterator<char>());
+            dir = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Directory of the registration file readers would load, empty if there is none
+static std::string registered_config_dir() {
+    for (const char* dir : kRegisteredConfigDirs) {
+        if (access((std::string(dir) + "/" + kRegisteredConfigName).c_str(), F_OK) == 0) {
+            return dir;
+        }
+    }
+    return "";
+}
+
+// First line of a journal amending the file with this generation; files written
+// before generations existed (generation 0) have journals without one
+static std::string journal_header(unsigned long long generation) {
+    return generation == 0 ? "" : "#" + std::to_string(generation) + "\n";
+}
+
+// Apply the journal in dir to instances if it amends the file with this generation;
+// returns the number of entries applied
+static size_t replay_instance_journal(const std::string& dir, unsigned long long generation, InstanceSet& instances) {
+    std::ifstream journal(dir + "/" + kInstanceJournalName);
+    if (!journal.is_open()) {
+        return 0;
+    }
+    std::string content((std::istreambuf_iterator<char>(journal)), std::istreambuf_iterator<char>());
+    std::string header = journal_header(generation);
+    bool current = header.empty() ? content.empty() || content[0] != '#' : content.compare(0, header.size(), header) == 0;
+    if (!current) {
+        // Left over from before the file was last rewritten; the file already reflects it
+        std::cout << "Ignoring stale " << kInstanceJournalName << " in " << dir << std::endl;
+        return 0;
+    }
+    size_t entries = 0;
+    size_t pos = header.size();
+    size_t eol;
+    // A line is committed only once its newline is written; a torn tail is ignored
+    while ((eol = content.find('\n', pos)) != std::string::npos) {
+        if (eol - pos >= 2) {
+            std::string id = content.substr(pos + 1, eol - pos - 1);
+            if (content[pos] == '+') {
+                instances.insert(id);
+                entries++;
+            } else if (content[pos] == '-') {
+                instances.erase(id);
+                entries++;
+            }
+        }
+        pos = eol + 1;
+    }
+    return entries;
+}
+
+// Append one "<op><id>" line to the journal in dir and make it durable; a journal for
+// another generation of the file is replaced. Caller holds g_journal_mutex
+static bool append_instance_journal(const std::string& dir, char op, const std::string& id) {
+    std::string journal_path = dir + "/" + kInstanceJournalName;
+    int fd = open(journal_path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Failed to open " << journal_path << ": " << std::strerror(errno) << std::endl;
+        return false;
     }
     
-    // Initialize with defaults
-    g_device_info = get_default_device_info();
+    struct stat st;
+    bool created = fstat(fd, &st) == 0 && st.st_size == 0;
+    std::string header = journal_header(g_config_generation);
+    if (!created && st.st_size > 0) {
+        char first[32];
+        ssize_t n = pread(fd, first, sizeof(first), 0);
+        bool current = n > 0 && (header.empty() ? first[0] != '#'
+                                                : (size_t)n >= header.size() && header.compare(0, header.size(), first, header.size()) == 0);
+        if (!current) {
+            // Stale (the file was rewritten but the journal not removed) or a torn header
+            if (ftruncate(fd, 0) != 0) {
+                std::cerr << "Error: Failed to reset " << journal_path << ": " << std::strerror(errno) << std::endl;
+                close(fd);
+                return false;
+            }
+            st.st_size = 0;
+        }
+    }
+    if (st.st_size > 0) {
+        // Drop a torn line left by a crash, otherwise the next entry would be glued to it
+        char last = '\n';
+        if (pread(fd, &last, 1, st.st_size - 1) == 1 && last != '\n') {
+            std::string content(st.st_size, '\0');
+            ssize_t n = pread(fd, &content[0], content.size(), 0);
+            size_t keep = 0;
+            if (n > 0) {
+                size_t eol = content.rfind('\n', (size_t)n - 1);
+                keep = eol == std::string::npos ? 0 : eol + 1;
+            }
+            if (ftruncate(fd, keep) != 0) {
+                std::cerr << "Error: Failed to repair " << journal_path << ": " << std::strerror(errno) << std::endl;
+                close(fd);
+                return false;
+            }
+        }
+    }
     
-    // FIRST: Try to load from device_registered.json (saved from POST)
-    // This takes priority over defaults and environment variables
-    // Try current directory first, then /etc
-    std::string config_path = "./device_registered.json";
-    std::ifstream saved_config(config_path);
+    std::string line = op + id + "\n";
+    if (st.st_size == 0) {
+        line = header + line;
+    }
+    bool ok = write(fd, line.data(), line.size()) == (ssize_t)line.size() && fdatasync(fd) == 0;
+    if (!ok) {
+        std::cerr << "Error: Failed to append to " << journal_path << ": " << std::strerror(errno) << std::endl;
+    }
+    close(fd);
+    
+    if (ok && created) {
+        // A new journal's directory entry must be durable too
+        int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        ok = dir_fd >= 0 && fsync(dir_fd) == 0;
+        if (dir_fd >= 0) close(dir_fd);
+    }
+    return ok;
+}
+
+// Instances when the registration file lists none: DEVICE_INSTANCES (comma-separated), else the system UUID
+static std::vector<std::string> get_default_device_instances(const std::string& system_uuid) {
+    std::vector<std::string> instances;
+    const char* env_instances = std::getenv("DEVICE_INSTANCES");
+    if (env_instances) {
+        std::istringstream iss(env_instances);
+        std::string instance;
+        while (std::getline(iss, instance, ',')) {
+            // Trim whitespace
+            instance.erase(0, instance.find_first_not_of(" \t"));
+            instance.erase(instance.find_last_not_of(" \t") + 1);
+            if (!instance.empty()) {
+                instances.push_back(instance);
+            }
+        }
+    }
     
-    if (!saved_config.is_open()) {
-        config_path = "/etc/device_registered.json";
-        saved_config.open(config_path);
+    if (instances.empty()) {
+        instances.push_back(system_uuid);
     }
+    return instances;
+}
+
+// Build the state from defaults, the registration file and environment overrides
+static std::shared_ptr<const DeviceState> build_device_state() {
+    auto state = std::make_shared<DeviceState>();
+    DeviceInfo& info = state->info;
+    InstanceSet& instances = state->instances;
     
-    if (saved_config.is_open()) {
-        std::string content((std::istreambuf_iterator<char>(saved_config)),
-                           std::istreambuf_iterator<char>());
-        saved_config.close();
-        
+    // Initialize with defaults
+    info = get_default_device_info();
+    
+    // FIRST: Try to load from device_registered.json (saved from POST)
+    // This takes priority over defaults and environment variables
+    std::string content;
+    std::string dir;
+    if (read_registered_config(content, dir)) {
         // Parse all registered fields from saved config
         std::string version = extract_json_string(content, "version");
-        if (!version.empty()) g_device_info.version = version;
+        if (!version.empty()) info.version = version;
         
         std::string serial = extract_json_string(content, "serial_number");
-        if (!serial.empty()) g_device_info.serial_number = serial;
+        if (!serial.empty()) info.serial_number = serial;
         
         std::string model = extract_json_string(content, "model_type");
-        if (!model.empty()) g_device_info.model_type = model;
+        if (!model.empty()) info.model_type = model;
         
         std::string device_type = extract_json_string(content, "device_type");
-        if (!device_type.empty()) g_device_info.device_type = device_type;
+        if (!device_type.empty()) info.device_type = device_type;
         
         std::string hw_rev = extract_json_string(content, "hardware_revision");
-        if (!hw_rev.empty()) g_device_info.hardware_revision = hw_rev;
+        if (!hw_rev.empty()) info.hardware_revision = hw_rev;
         
         std::string prod_date = extract_json_string(content, "production_date");
-        if (!prod_date.empty()) g_device_info.production_date = prod_date;
+        if (!prod_date.empty()) info.production_date = prod_date;
         
         std::string warranty = extract_json_string(content, "warranty_period");
-        if (!warranty.empty()) g_device_info.warranty_period = warranty;
+        if (!warranty.empty()) info.warranty_period = warranty;
         
         std::string build_date = extract_json_string(content, "build_date");
-        if (!build_date.empty()) g_device_info.build_date = build_date;
+        if (!build_date.empty()) info.build_date = build_date;
         
         std::string mode = extract_json_string(content, "mode");
-        if (!mode.empty()) g_device_info.mode = mode;
+        if (!mode.empty()) info.mode = mode;
         
         std::string port = extract_json_string(content, "endpoint_port");
-        if (!port.empty()) g_device_info.endpoint_port = port;
+        if (!port.empty()) info.endpoint_port = port;
         
-        // Load instances
-        std::vector<std::string> instances = extract_json_array(content, "instances");
-        if (!instances.empty()) {
-            set_device_instances(instances);
-        }
+        // Load instances, then the PUT/DELETE operations made since the file was written
+        g_config_generation = std::strtoull(extract_json_string(content, "journal_generation").c_str(), nullptr, 10);
+        instances = InstanceSet(extract_json_array(content, "instances"));
+        g_journal_entries = replay_instance_journal(dir, g_config_generation, instances);
+    } else {
+        g_config_generation = 0;
     }
     
     // Override with environment variables if available (only if not loaded from file)
     const char* env_version = std::getenv("DEVICE_VERSION");
-    if (env_version) g_device_info.version = env_version;
+    if (env_version) info.version = env_version;
     
     const char* env_serial = std::getenv("DEVICE_SERIAL_NUMBER");
-    if (env_serial) g_device_info.serial_number = env_serial;
+    if (env_serial) info.serial_number = env_serial;
     
     const char* env_model = std::getenv("DEVICE_MODEL_TYPE");
-    if (env_model) g_device_info.model_type = env_model;
+    if (env_model) info.model_type = env_model;
     
     const char* env_firmware = std::getenv("DEVICE_FIRMWARE_VERSION");
-    if (env_firmware) g_device_info.firmware_version = env_firmware;
+    if (env_firmware) info.firmware_version = env_firmware;
     
     const char* env_hw_id = std::getenv("DEVICE_HARDWARE_ID");
-    if (env_hw_id) g_device_info.hardware_id = env_hw_id;
+    if (env_hw_id) info.hardware_id = env_hw_id;
     
     const char* env_manufacturer = std::getenv("DEVICE_MANUFACTURER");
-    if (env_manufacturer) g_device_info.manufacturer = env_manufacturer;
+    if (env_manufacturer) info.manufacturer = env_manufacturer;
     
     const char* env_device_type = std::getenv("DEVICE_TYPE");
-    if (env_device_type) g_device_info.device_type = env_device_type;
+    if (env_device_type) info.device_type = env_device_type;
     
     const char* env_hw_rev = std::getenv("DEVICE_HARDWARE_REVISION");
-    if (env_hw_rev) g_device_info.hardware_revision = env_hw_rev;
+    if (env_hw_rev) info.hardware_revision = env_hw_rev;
     
     const char* env_prod_date = std::getenv("DEVICE_PRODUCTION_DATE");
-    if (env_prod_date) g_device_info.production_date = env_prod_date;
+    if (env_prod_date) info.production_date = env_prod_date;
     
     const char* env_warranty = std::getenv("DEVICE_WARRANTY_PERIOD");
-    if (env_warranty) g_device_info.warranty_period = env_warranty;
+    if (env_warranty) info.warranty_period = env_warranty;
     
     const char* env_support = std::getenv("DEVICE_SUPPORT_CONTACT");
-    if (env_support) g_device_info.support_contact = env_support;
+    if (env_support) info.support_contact = env_support;
     
     const char* env_docs = std::getenv("DEVICE_DOCUMENTATION_URL");
-    if (env_docs) g_device_info.documentation_url = env_docs;
+    if (env_docs) info.documentation_url = env_docs;
     
     const char* env_mode = std::getenv("DEVICE_MODE");
-    if (env_mode) g_device_info.mode = env_mode;
+    if (env_mode) info.mode = env_mode;
     
     const char* env_port = std::getenv("DEVICE_ENDPOINT_PORT");
-    if (env_port && g_device_info.endpoint_port.empty()) {
-        g_device_info.endpoint_port = env_port;
+    if (env_port && info.endpoint_port.empty()) {
+        info.endpoint_port = env_port;
     }
     
     // Read system UUID (cached, only read once)
-    g_device_info.system_uuid = read_system_uuid();
+    info.system_uuid = read_system_uuid();
+    
+    // Resolve instances now so that get_device_instances() never touches the filesystem
+    if (instances.empty()) {
+        instances = InstanceSet(get_default_device_instances(info.system_uuid));
+        state->default_instances = true;
+    }
     
-    g_config_loaded = true;
+    return state;
 }
 
-void reload_device_config() {
-    g_config_loaded = false;
-    g_device_instances.clear();
-    g_last_instances_file_mtime = 0; // Reset modification time tracking
-    
-    // Load config (this will also load instances from file)
-    load_device_config();
-    
-    // Ensure instances are loaded from file
-    std::string config_path = "./device_registered.json";
-    std::ifstream saved_config(config_path);
-    
-    if (!saved_config.is_open()) {
-        config_path = "/etc/device_registered.json";
-        saved_config.open(config_path);
+// Caller holds g_state_write_mutex
+static void publish_device_state(std::shared_ptr<const DeviceState> state) {
+    std::atomic_store(&g_device_state, std::move(state));
+    g_device_state_version.fetch_add(1, std::memory_order_release);
+}
+
+void load_device_config() {
+    if (g_device_state_version.load(std::memory_order_acquire) != 0) {
+        return;
     }
-    
-    if (saved_config.is_open()) {
-        std::string content((std::istreambuf_iterator<char>(saved_config)),
-                           std::istreambuf_iterator<char>());
-        saved_config.close();
-        std::vector<std::string> instances = extract_json_array(content, "instances");
-        if (!instances.empty()) {
-            g_device_instances = instances;
-        }
-        
-        // Update modification time tracking
-        struct stat file_stat;
-        if (stat(config_path.c_str(), &file_stat) == 0) {
-            g_last_instances_file_mtime = file_stat.st_mtime;
-        }
+    std::lock_guard<std::mutex> lock(g_state_write_mutex);
+    // Another thread may have loaded it while we waited
+    if (!g_device_state) {
+        publish_device_state(build_device_state());
     }
 }
 
-DeviceInfo get_device_info() {
-    if (!g_config_loaded) {
+void reload_device_config() {
+    // The journal lock keeps a compaction from being read half done (new file, old journal)
+    std::lock_guard<std::mutex> journal_lock(g_journal_mutex);
+    std::lock_guard<std::mutex> lock(g_state_write_mutex);
+    publish_device_state(build_device_state());
+    g_state_dirty = false;
+}
+
+std::shared_ptr<const DeviceState> get_device_state() {
+    // Each thread keeps the last state it loaded; while the version is unchanged a read is
+    // one atomic load plus a reference count increment, with no lock shared between threads.
+    // The cache holds the previous state alive until this thread's next call after a publish
+    thread_local unsigned long long cached_version = 0;
+    thread_local std::shared_ptr<const DeviceState> cached_state;
+    
+    unsigned long long version = g_device_state_version.load(std::memory_order_acquire);
+    if (version == 0) {
         load_device_config();
+        version = g_device_state_version.load(std::memory_order_acquire);
     }
-    return g_device_info;
+    if (version != cached_version) {
+        // Loaded after the version, so it is at least that new; a newer state is picked up again
+        // on the next call since its version differs from the one recorded here
+        cached_state = std::atomic_load(&g_device_state);
+        cached_version = version;
+    }
+    return cached_state;
+}
+
+DeviceInfo get_device_info() {
+    return get_device_state()->info;
 }
 
 DeviceStatus get_device_status() {
     DeviceStatus status;
     
     // Read uptime from /proc/uptime
-    std::ifstream uptime_file("/proc/uptime");
+    std::ifstream uptime_file(host_proc_root() + "/uptime");
     if (uptime_file.is_open()) {
         double uptime_seconds;
         uptime_file >> uptime_seconds;
@@ -403,93 +615,22 @@ DeviceStatus get_device_status() {
 }
 
 std::vector<std::string> get_device_instances() {
-    // Check if file has been modified since last load
-    std::string config_path = "./device_registered.json";
-    struct stat file_stat;
-    bool file_exists = (stat(config_path.c_str(), &file_stat) == 0);
-    
-    if (!file_exists) {
-        config_path = "/etc/device_registered.json";
-        file_exists = (stat(config_path.c_str(), &file_stat) == 0);
-    }
-    
-    // If file exists and has been modified, clear cache and reload
-    if (file_exists) {
-        time_t current_mtime = file_stat.st_mtime;
-        if (current_mtime != g_last_instances_file_mtime) {
-            // File has been modified, clear cache
-            g_device_instances.clear();
-            g_last_instances_file_mtime = current_mtime;
-        }
-    }
-    
-    // If instances are already cached, return them (fast path)
-    if (!g_device_instances.empty()) {
-        return g_device_instances;
-    }
-    
-    // Try to read from saved config file
-    // Try current directory first, then /etc
-    std::vector<std::string> instances;
-    config_path = "./device_registered.json";
-    std::ifstream saved_config(config_path);
-    
-    if (!saved_config.is_open()) {
-        config_path = "/etc/device_registered.json";
-        saved_config.open(config_path);
-    }
-    
-    if (saved_config.is_open()) {
-        std::string content((std::istreambuf_iterator<char>(saved_config)),
-                           std::istreambuf_iterator<char>());
-        saved_config.close();
-        instances = extract_json_array(content, "instances");
-        
-        // Update modification time tracking
-        if (stat(config_path.c_str(), &file_stat) == 0) {
-            g_last_instances_file_mtime = file_stat.st_mtime;
-        }
-    }
-    
-    // If loaded from file, cache and return
-    if (!instances.empty()) {
-        g_device_instances = instances;
-        return instances;
-    }
-    
-    // Try to read from environment variable (comma-separated)
-    const char* env_instances = std::getenv("DEVICE_INSTANCES");
-    if (env_instances) {
-        std::istringstream iss(env_instances);
-        std::string instance;
-        while (std::getline(iss, instance, ',')) {
-            // Trim whitespace
-            instance.erase(0, instance.find_first_not_of(" \t"));
-            instance.erase(instance.find_last_not_of(" \t") + 1);
-            if (!instance.empty()) {
-                instances.push_back(instance);
-            }
-        }
-    }
-    
-    // Default instance (use system UUID if no instances configured)
-    if (instances.empty()) {
-        DeviceInfo info = get_device_info();
-        instances.push_back(info.system_uuid);
-    }
-    
-    g_device_instances = instances;
-    return instances;
+    // Kept current by POST/PUT/DELETE publishing and by the config watcher
+    return get_device_state()->instances.to_vector();
 }
 
 void set_device_instances(const std::vector<std::string>& instances) {
-    g_device_instances = instances;
+    load_device_config();
+    std::lock_guard<std::mutex> lock(g_state_write_mutex);
+    auto state = std::make_shared<DeviceState>(*g_device_state);
+    state->instances = InstanceSet(instances);
+    state->default_instances = false;
+    publish_device_state(std::shared_ptr<const DeviceState>(state));
+    g_state_dirty = true;
 }
 
 bool update_device_config_from_json(const std::string& json_str) {
-    if (!g_config_loaded) {
-        load_device_config();
-    }
+    load_device_config();
     
     // Extract device object
     size_t device_start = json_str.find("\"device\"");
@@ -516,37 +657,42 @@ bool update_device_config_from_json(const std::string& json_str) {
     
     std::string device_json = json_str.substr(device_start, device_end - device_start);
     
+    // Copy the current state, apply the update, then publish it; readers keep the old one meanwhile
+    std::lock_guard<std::mutex> lock(g_state_write_mutex);
+    auto state = std::make_shared<DeviceState>(*g_device_state);
+    DeviceInfo& info = state->info;
+    
     // Update fields marked for registration (# đăng ký)
     std::string version = extract_json_string(device_json, "version");
-    if (!version.empty()) g_device_info.version = version;
+    if (!version.empty()) info.version = version;
     
     std::string serial = extract_json_string(device_json, "serial_number");
-    if (!serial.empty()) g_device_info.serial_number = serial;
+    if (!serial.empty()) info.serial_number = serial;
     
     std::string model = extract_json_string(device_json, "model_type");
-    if (!model.empty()) g_device_info.model_type = model;
+    if (!model.empty()) info.model_type = model;
     
     std::string device_type = extract_json_string(device_json, "device_type");
-    if (!device_type.empty()) g_device_info.device_type = device_type;
+    if (!device_type.empty()) info.device_type = device_type;
     
     std::string hw_rev = extract_json_string(device_json, "hardware_revision");
-    if (!hw_rev.empty()) g_device_info.hardware_revision = hw_rev;
+    if (!hw_rev.empty()) info.hardware_revision = hw_rev;
     
     std::string prod_date = extract_json_string(device_json, "production_date");
-    if (!prod_date.empty()) g_device_info.production_date = prod_date;
+    if (!prod_date.empty()) info.production_date = prod_date;
     
     std::string warranty = extract_json_string(device_json, "warranty_period");
-    if (!warranty.empty()) g_device_info.warranty_period = warranty;
+    if (!warranty.empty()) info.warranty_period = warranty;
     
     std::string build_date = extract_json_string(device_json, "build_date");
-    if (!build_date.empty()) g_device_info.build_date = build_date;
+    if (!build_date.empty()) info.build_date = build_date;
     
     std::string mode = extract_json_string(device_json, "mode");
-    if (!mode.empty()) g_device_info.mode = mode;
+    if (!mode.empty()) info.mode = mode;
     
     // Extract endpoint_port (at root level)
     std::string port = extract_json_string(json_str, "endpoint_port");
-    if (!port.empty()) g_device_info.endpoint_port = port;
+    if (!port.empty()) info.endpoint_port = port;
     
     // Extract instances (at root level)
     std::vector<std::string> instances = extract_json_array(json_str, "instances");
@@ -555,94 +701,353 @@ bool update_device_config_from_json(const std::string& json_str) {
         std::cout << "DEBUG: Instance[" << i << "] = " << instances[i] << std::endl;
     }
     if (!instances.empty()) {
-        set_device_instances(instances);
+        state->instances = InstanceSet(instances);
+        state->default_instances = false;
         std::cout << "DEBUG: Set device instances successfully" << std::endl;
     } else {
         std::cout << "DEBUG: WARNING - No instances found in JSON or extraction failed" << std::endl;
     }
     
+    publish_device_state(std::shared_ptr<const DeviceState>(state));
+    g_state_dirty = true;
     return true;
 }
 
-bool save_device_config() {
-    // Save registered fields to file
-    // Try current directory first (for development), then /etc (for production)
-    std::string config_path = "./device_registered.json";
-    std::ofstream config_file(config_path);
-    
-    if (!config_file.is_open()) {
-        config_path = "/etc/device_registered.json";
-        config_file.open(config_path);
+// Registered fields as written to device_registered.json
+static std::string format_registered_config(const DeviceState& state, unsigned long long generation) {
+    const DeviceInfo& info = state.info;
+    std::ostringstream config_file;
+    config_file << "{\n";
+    config_file << "  \"version\": \"" << escape_json(info.version) << "\",\n";
+    config_file << "  \"serial_number\": \"" << escape_json(info.serial_number) << "\",\n";
+    config_file << "  \"model_type\": \"" << escape_json(info.model_type) << "\",\n";
+    config_file << "  \"device_type\": \"" << escape_json(info.device_type) << "\",\n";
+    config_file << "  \"hardware_revision\": \"" << escape_json(info.hardware_revision) << "\",\n";
+    config_file << "  \"production_date\": \"" << escape_json(info.production_date) << "\",\n";
+    config_file << "  \"warranty_period\": \"" << escape_json(info.warranty_period) << "\",\n";
+    config_file << "  \"build_date\": \"" << escape_json(info.build_date) << "\",\n";
+    config_file << "  \"mode\": \"" << escape_json(info.mode) << "\",\n";
+    config_file << "  \"endpoint_port\": \"" << escape_json(info.endpoint_port) << "\",\n";
+    
+    // Save instances - the in-memory list holds the NEW values from POST (or the
+    // existing ones from file when the POST had none), so never re-read the file here
+    const InstanceSet& instances = state.instances;
+    config_file << "  \"instances\": [\n";
+    size_t written = 0;
+    for (const auto& instance : instances) {
+        config_file << "    \"" << escape_json(instance) << "\"";
+        if (++written < instances.size()) config_file << ",";
+        config_file << "\n";
     }
+    config_file << "  ],\n";
+    config_file << "  \"journal_generation\": " << generation << "\n";
     
-    if (!config_file.is_open()) {
+    config_file << "}\n";
+    return config_file.str();
+}
+
+// Replace dir/device_registered.json atomically; caller holds g_journal_mutex: write a temp file, fsync it, rename it
+// over the old file and fsync the directory, so a crash leaves the old or the new
+// content but never a truncated file. The file now holds every journaled instance
+// operation, so the journal is removed with the same directory sync
+// Returns false without logging if dir is not writable
+static bool write_registered_config(const std::string& dir, const std::string& content) {
+    std::string config_path = dir + "/" + kRegisteredConfigName;
+    std::string tmp_path = config_path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
         return false;
     }
     
-    config_file << "{\n";
-    config_file << "  \"version\": \"" << escape_json(g_device_info.version) << "\",\n";
-    config_file << "  \"serial_number\": \"" << escape_json(g_device_info.serial_number) << "\",\n";
-    config_file << "  \"model_type\": \"" << escape_json(g_device_info.model_type) << "\",\n";
-    config_file << "  \"device_type\": \"" << escape_json(g_device_info.device_type) << "\",\n";
-    config_file << "  \"hardware_revision\": \"" << escape_json(g_device_info.hardware_revision) << "\",\n";
-    config_file << "  \"production_date\": \"" << escape_json(g_device_info.production_date) << "\",\n";
-    config_file << "  \"warranty_period\": \"" << escape_json(g_device_info.warranty_period) << "\",\n";
-    config_file << "  \"build_date\": \"" << escape_json(g_device_info.build_date) << "\",\n";
-    config_file << "  \"mode\": \"" << escape_json(g_device_info.mode) << "\",\n";
-    config_file << "  \"endpoint_port\": \"" << escape_json(g_device_info.endpoint_port) << "\",\n";
-    
-    // Save instances - ALWAYS use g_device_instances if set, don't read from file
-    // because we're saving the NEW values, not the old ones from file
-    std::vector<std::string> instances = g_device_instances;
-    std::cout << "DEBUG: Saving " << instances.size() << " instances to file (g_device_instances.size() = " << g_device_instances.size() << ")" << std::endl;
-    for (size_t i = 0; i < instances.size(); ++i) {
-        std::cout << "DEBUG: Saving instance[" << i << "] = " << instances[i] << std::endl;
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t n = write(fd, content.data() + written, content.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        written += n;
     }
-    
-    // If instances is empty, it means no instances were set in the POST request
-    // In this case, we should keep the existing instances from file
-    if (instances.empty()) {
-        std::cout << "DEBUG: No instances in memory, reading from file to preserve existing values" << std::endl;
-        instances = get_device_instances();
+    bool ok = written == content.size() && fsync(fd) == 0;
+    // rename() keeps the inode and mtime, so this is what the watcher will find
+    struct stat st;
+    ok = ok && fstat(fd, &st) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(tmp_path.c_str(), config_path.c_str()) != 0) {
+        std::cerr << "Error: Failed to write " << config_path << ": " << std::strerror(errno) << std::endl;
+        unlink(tmp_path.c_str());
+        return false;
     }
-    config_file << "  \"instances\": [\n";
-    for (size_t i = 0; i < instances.size(); ++i) {
-        config_file << "    \"" << escape_json(instances[i]) << "\"";
-        if (i < instances.size() - 1) config_file << ",";
-        config_file << "\n";
+    g_written_config_dir = dir;
+    g_written_config_stat = st;
+    unlink((dir + "/" + kInstanceJournalName).c_str());
+    
+    // The rename and unlink are only durable once the directory entries are
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0 || fsync(dir_fd) != 0) {
+        std::cerr << "Error: Failed to sync directory " << dir << ": " << std::strerror(errno) << std::endl;
+        if (dir_fd >= 0) close(dir_fd);
+        return false;
+    }
+    close(dir_fd);
+    std::cout << "Successfully saved device configuration to " << config_path << std::endl;
+    return true;
+}
+
+// Save registered fields to file; caller holds g_journal_mutex
+// Try current directory first (for development), then /etc (for production)
+static bool write_device_config(const DeviceState& state) {
+    // A new generation, so a journal this write fails to remove is never replayed onto it
+    unsigned long long generation = g_config_generation + 1;
+    std::string content = format_registered_config(state, generation);
+    for (const char* dir : kRegisteredConfigDirs) {
+        if (write_registered_config(dir, content)) {
+            g_config_generation = generation;
+            g_journal_entries = 0;
+            return true;
+        }
+    }
+    std::cerr << "Error: Failed to write " << kRegisteredConfigName << " to any of ./ or /etc" << std::endl;
+    return false;
+}
+
+bool save_device_config() {
+    std::unique_lock<std::mutex> lock(g_save_mutex);
+    unsigned long long generation = ++g_save_requested;
+    
+    while (g_save_attempted < generation) {
+        if (g_save_writing) {
+            // Another POST is writing; it or the next writer covers this generation
+            g_save_cv.wait(lock);
+            continue;
+        }
+        
+        // Become the writer for every generation requested so far and within the window
+        g_save_writing = true;
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(kSaveCoalesceWindowMs));
+        lock.lock();
+        unsigned long long covered = g_save_requested;
+        lock.unlock();
+        
+        // Each POST published its update before requesting a save, so the
+        // current state includes the updates of all covered generations
+        bool ok;
+        {
+            std::lock_guard<std::mutex> journal_lock(g_journal_mutex);
+            std::shared_ptr<const DeviceState> state = get_device_state();
+            ok = write_device_config(*state);
+            // Attempted either way: a failed POST's state may be replaced by an external edit
+            std::lock_guard<std::mutex> state_lock(g_state_write_mutex);
+            if (std::atomic_load(&g_device_state) == state) {
+                g_state_dirty = false;
+            }
+        }
+        
+        lock.lock();
+        g_save_writing = false;
+        g_save_attempted = covered;
+        if (ok) {
+            g_save_durable = covered;
+        }
+        g_save_cv.notify_all();
     }
-    config_file << "  ]\n";
-    
-    config_file << "}\n";
-    config_file.flush(); // Ensure data is written immediately
     
-    // Verify file was written successfully BEFORE closing
-    if (!config_file.good()) {
-        std::cerr << "Error: Failed to write device_registered.json to " << config_path << std::endl;
-        config_file.close();
+    // A later successful write also covers this generation's data
+    return g_save_durable >= generation;
+}
+
+bool is_valid_instance_id(const std::string& id) {
+    if (id.empty() || id.size() > 256) {
         return false;
     }
+    // Ids are stored unescaped, one per journal line
+    for (char c : id) {
+        if ((unsigned char)c < 0x20 || c == 0x7f || c == '"' || c == '\\') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Add or remove one instance: journal the operation (or compact), then publish
+static bool change_device_instance(const std::string& id, bool add, bool& changed) {
+    load_device_config();
+    std::lock_guard<std::mutex> journal_lock(g_journal_mutex);
+    std::lock_guard<std::mutex> state_lock(g_state_write_mutex);
+    std::shared_ptr<const DeviceState> current = std::atomic_load(&g_device_state);
     
-    config_file.close();
-    
-    // Update modification time tracking after successful save
-    struct stat file_stat;
-    if (stat(config_path.c_str(), &file_stat) == 0) {
-        g_last_instances_file_mtime = file_stat.st_mtime;
-        std::cout << "Successfully saved device configuration to " << config_path << std::endl;
-        std::cout << "File modification time: " << file_stat.st_mtime << std::endl;
+    changed = add ? !current->instances.contains(id) : current->instances.contains(id);
+    if (!changed) {
+        return true;
+    }
+    auto state = std::make_shared<DeviceState>(*current);
+    if (add) {
+        state->instances.insert(id);
     } else {
-        std::cerr << "Warning: Could not stat saved file " << config_path << std::endl;
+        state->instances.erase(id);
+    }
+    state->default_instances = false;
+    
+    // Default instances were never written; they must reach the file before a journal can amend it
+    std::string dir = registered_config_dir();
+    bool compact = current->default_instances || dir.empty() ||
+                   g_journal_entries >= std::max(kJournalCompactMinEntries, state->instances.size());
+    if (compact) {
+        if (!write_device_config(*state)) {
+            return false;
+        }
+        std::cout << "Compacted instance journal into " << kRegisteredConfigName
+                  << " (" << state->instances.size() << " instances)" << std::endl;
+    } else {
+        if (!append_instance_journal(dir, add ? '+' : '-', id)) {
+            return false;
+        }
+        g_journal_entries++;
     }
     
+    // Durable first, visible second: a failed write leaves the published state unchanged
+    publish_device_state(std::shared_ptr<const DeviceState>(state));
+    if (compact) {
+        // The file now holds every published update
+        g_state_dirty = false;
+    }
     return true;
 }
 
+bool add_device_instance(const std::string& id, bool& added) {
+    return change_device_instance(id, true, added);
+}
+
+bool remove_device_instance(const std::string& id, bool& removed) {
+    return change_device_instance(id, false, removed);
+}
+
 std::string get_endpoint_port() {
-    if (!g_config_loaded) {
-        load_device_config();
+    // Always return the current value from the published state (which should be loaded from file)
+    const std::string& port = get_device_state()->info.endpoint_port;
+    return port.empty() ? "3546" : port;
+}
+
+
+// Config watcher
+
+static std::mutex g_watcher_mutex;
+static std::thread g_watcher_thread;
+static int g_watcher_inotify_fd = -1;
+static int g_watcher_wakeup_fd = -1;
+
+static bool same_file_version(const struct stat& a, const struct stat& b) {
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino && a.st_size == b.st_size &&
+           a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+// Reload after the watcher saw the registration file change, unless the file readers
+// would load is the one this process wrote last, or published updates are still
+// waiting for save_device_config() (which replaces the file with them anyway)
+// Returns true if the state was rebuilt from the file
+static bool reload_changed_device_config() {
+    std::lock_guard<std::mutex> journal_lock(g_journal_mutex);
+    std::lock_guard<std::mutex> lock(g_state_write_mutex);
+    if (g_state_dirty) {
+        return false;
+    }
+    std::string dir = registered_config_dir();
+    struct stat st;
+    if (!dir.empty() && dir == g_written_config_dir &&
+        stat((dir + "/" + kRegisteredConfigName).c_str(), &st) == 0 &&
+        same_file_version(st, g_written_config_stat)) {
+        return false;
+    }
+    publish_device_state(build_device_state());
+    return true;
+}
+
+static void config_watcher_loop() {
+    struct pollfd pfds[2] = {
+        {g_watcher_wakeup_fd, POLLIN, 0},
+        {g_watcher_inotify_fd, POLLIN, 0},
+    };
+    alignas(struct inotify_event) char buffer[4096];
+    
+    while (true) {
+        int n = poll(pfds, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfds[0].revents & POLLIN) {
+            break;  // Stop requested
+        }
+        if (!(pfds[1].revents & POLLIN)) {
+            continue;
+        }
+        
+        // Drain everything queued so that an editor's write + rename burst reloads once
+        bool changed = false;
+        ssize_t len;
+        while ((len = read(g_watcher_inotify_fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + len; ) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+                if ((event->mask & IN_Q_OVERFLOW) ||
+                    (event->len > 0 && std::strcmp(event->name, kRegisteredConfigName) == 0)) {
+                    changed = true;
+                }
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        if (changed && reload_changed_device_config()) {
+            std::cout << "Reloaded device configuration (" << kRegisteredConfigName << " changed)" << std::endl;
+        }
+    }
+}
+
+bool start_device_config_watcher() {
+    std::lock_guard<std::mutex> lock(g_watcher_mutex);
+    if (g_watcher_thread.joinable()) {
+        return true;
     }
-    // Always return the current value from g_device_info (which should be loaded from file)
-    return g_device_info.endpoint_port.empty() ? "3546" : g_device_info.endpoint_port;
+    
+    g_watcher_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_watcher_inotify_fd < 0) {
+        std::cerr << "Device config watcher: inotify_init1 failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // Watch the directories, not the file: it may not exist yet, and a rename over it replaces the inode
+    int watched = 0;
+    for (const char* dir : kRegisteredConfigDirs) {
+        if (inotify_add_watch(g_watcher_inotify_fd, dir,
+                              IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) >= 0) {
+            watched++;
+        }
+    }
+    
+    if (watched > 0) {
+        g_watcher_wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    }
+    if (watched == 0 || g_watcher_wakeup_fd < 0) {
+        close(g_watcher_inotify_fd);
+        g_watcher_inotify_fd = -1;
+        return false;
+    }
+    g_watcher_thread = std::thread(config_watcher_loop);
+    return true;
 }
 
+void stop_device_config_watcher() {
+    std::lock_guard<std::mutex> lock(g_watcher_mutex);
+    if (!g_watcher_thread.joinable()) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(g_watcher_wakeup_fd, &one, sizeof(one)) < 0) {
+        // Nothing else to do; join below would hang, so detach instead
+        g_watcher_thread.detach();
+        return;
+    }
+    g_watcher_thread.join();
+    close(g_watcher_wakeup_fd);
+    g_watcher_wakeup_fd = -1;
+    close(g_watcher_inotify_fd);
+    g_watcher_inotify_fd = -1;
+}
@@ -0,0 +1,143 @@
+#include "disk_io_stats.h"
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+// /proc/diskstats always counts in 512-byte sectors, regardless of device
+static const unsigned long long kSectorBytes = 512;
+
+DiskIoCollector::DiskIoCollector(bool include_partitions,
+                                 const std::string& diskstats_path,
+                                 const std::string& sys_block_path)
+    : include_partitions_(include_partitions),
+      sys_block_path_(sys_block_path),
+      reader_(diskstats_path),
+      has_previous_(false) {
+    slots_.reserve(16);
+}
+
+long DiskIoCollector::slot_for(const char* name, size_t len, size_t line_index) {
+    // Devices are listed in a stable order: try last pass's answer for this line
+    if (line_index < line_names_.size()) {
+        const std::string& hint = line_names_[line_index];
+        if (hint.size() == len && std::memcmp(hint.data(), name, len) == 0) {
+            return line_slots_[line_index];
+        }
+    }
+
+    std::string key(name, len);
+    long slot;
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        slot = it->second;
+    } else {
+        // Classify once per device name; ram/loop devices never carry real I/O
+        struct stat st;
+        bool is_partition = stat((sys_block_path_ + "/" + key + "/partition").c_str(), &st) == 0;
+        bool is_virtual = key.compare(0, 4, "loop") == 0 || key.compare(0, 3, "ram") == 0;
+        if (is_virtual || (is_partition && !include_partitions_)) {
+            slot = -1;
+        } else {
+            slot = (long)slots_.size();
+            slots_.emplace_back();
+            slots_.back().name = key;
+            slots_.back().is_partition = is_partition;
+        }
+        index_.emplace(key, slot);
+    }
+
+    if (line_index < line_names_.size()) {
+        line_names_[line_index] = key;
+        line_slots_[line_index] = slot;
+    } else {
+        line_names_.push_back(key);
+        line_slots_.push_back(slot);
+    }
+    return slot;
+}
+
+static double counter_rate(unsigned long long prev, unsigned long long cur, double seconds) {
+    if (cur < prev || seconds <= 0) return 0.0;
+    return (double)(cur - prev) / seconds;
+}
+
+static unsigned long long counter_delta(unsigned long long prev, unsigned long long cur) {
+    return cur >= prev ? cur - prev : 0;
+}
+
+bool DiskIoCollector::collect() {
+    if (!reader_.read()) {
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = has_previous_ ? std::chrono::duration<double>(now - last_time_).count() : 0.0;
+
+    previous_present_.resize(slots_.size());
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        previous_present_[i] = slots_[i].present;
+        slots_[i].present = false;
+    }
+
+    const char* p = reader_.data();
+    const char* end = p + reader_.size();
+    size_t line_index = 0;
+
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+
+        // major minor name, then at least 11 counters
+        char* cursor = const_cast<char*>(p);
+        std::strtoul(cursor, &cursor, 10);
+        std::strtoul(cursor, &cursor, 10);
+        while (cursor < line_end && *cursor == ' ') ++cursor;
+        const char* name = cursor;
+        while (cursor < line_end && *cursor != ' ') ++cursor;
+        size_t name_len = cursor - name;
+
+        if (name_len > 0) {
+            long slot = slot_for(name, name_len, line_index++);
+            if (slot >= 0) {
+                unsigned long long v[11] = {};
+                for (int i = 0; i < 11 && cursor < line_end; ++i) {
+                    v[i] = std::strtoull(cursor, &cursor, 10);
+                }
+
+                DiskIoStats& d = slots_[slot];
+                if ((size_t)slot < previous_present_.size() && previous_present_[slot] && seconds > 0) {
+                    unsigned long long reads = counter_delta(d.reads_completed, v[0]);
+                    unsigned long long writes = counter_delta(d.writes_completed, v[4]);
+                    unsigned long long read_ms = counter_delta(d.read_time_ms, v[3]);
+                    unsigned long long write_ms = counter_delta(d.write_time_ms, v[7]);
+                    unsigned long long busy_ms = counter_delta(d.io_time_ms, v[9]);
+
+                    d.reads_per_sec = reads / seconds;
+                    d.writes_per_sec = writes / seconds;
+                    d.read_bytes_per_sec = counter_rate(d.sectors_read, v[2], seconds) * kSectorBytes;
+                    d.write_bytes_per_sec = counter_rate(d.sectors_written, v[6], seconds) * kSectorBytes;
+                    d.read_await_ms = reads > 0 ? (double)read_ms / reads : 0.0;
+                    d.write_await_ms = writes > 0 ? (double)write_ms / writes : 0.0;
+                    d.await_ms = (reads + writes) > 0 ? (double)(read_ms + write_ms) / (reads + writes) : 0.0;
+                    d.util_percent = 100.0 * busy_ms / (seconds * 1000.0);
+                    if (d.util_percent > 100.0) d.util_percent = 100.0;
+                }
+                d.reads_completed = v[0];
+                d.sectors_read = v[2];
+                d.read_time_ms = v[3];
+                d.writes_completed = v[4];
+                d.sectors_written = v[6];
+                d.write_time_ms = v[7];
+                d.ios_in_progress = v[8];
+                d.io_time_ms = v[9];
+                d.present = true;
+            }
+        }
+
+        p = line_end + 1;
+    }
+
+    last_time_ = now;
+    has_previous_ = true;
+    return true;
+}
@@ -0,0 +1,155 @@
+#include "filesystem_stats.h"
+#include <cstring>
+#include <set>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/statvfs.h>
+
+// Pseudo and virtual filesystems that do not hold user data
+static const char* const kPseudoFsTypes[] = {
+    "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs",
+    "devpts", "devtmpfs", "efivarfs", "fusectl", "hugetlbfs", "mqueue", "nsfs",
+    "proc", "pstore", "ramfs", "rpc_pipefs", "securityfs", "selinuxfs",
+    "squashfs", "sysfs", "tmpfs", "tracefs", "overlay", "nfsd", "fuse.lxcfs",
+    "fuse.portal", "fuse.gvfsd-fuse",
+};
+
+static bool is_pseudo_fs(const std::string& type) {
+    for (const char* pseudo : kPseudoFsTypes) {
+        if (type == pseudo) return true;
+    }
+    return false;
+}
+
+// mountinfo escapes space, tab, newline and backslash as \ooo
+static std::string unescape_mount_field(const char* begin, const char* end) {
+    std::string out;
+    out.reserve(end - begin);
+    for (const char* p = begin; p < end; ++p) {
+        if (*p == '\\' && end - p >= 4 &&
+            p[1] >= '0' && p[1] <= '7' && p[2] >= '0' && p[2] <= '7' && p[3] >= '0' && p[3] <= '7') {
+            out += (char)(((p[1] - '0') << 6) | ((p[2] - '0') << 3) | (p[3] - '0'));
+            p += 3;
+        } else {
+            out += *p;
+        }
+    }
+    return out;
+}
+
+// Model of the disk behind a mountinfo major:minor, as hwinfo reported it for whole disks.
+// A partition's sysfs directory sits inside its disk's, so ".." reaches the disk
+static std::string disk_model(const std::string& sys_root, const std::string& dev_id) {
+    std::string base = sys_root + "/dev/block/" + dev_id;
+    if (access((base + "/partition").c_str(), F_OK) == 0) {
+        base += "/..";
+    }
+    std::string model = read_sysfs_string(base + "/device/model");
+    if (model.empty()) {
+        model = read_sysfs_string(base + "/device/name");  // MMC/SD cards
+    }
+    return model;
+}
+
+std::string host_mountinfo_path() {
+    if (host_proc_root() == "/proc") {
+        return "/proc/self/mountinfo";
+    }
+    // A container's own mounts are not the host's; PID 1 of the host procfs is
+    return host_proc_root() + "/1/mountinfo";
+}
+
+FilesystemCollector::FilesystemCollector(const std::string& mountinfo_path, const std::string& rootfs,
+                                         const std::string& sys_root)
+    : reader_(mountinfo_path), rootfs_(rootfs), sys_root_(sys_root), parsed_(false), parses_(0) {
+}
+
+bool FilesystemCollector::mount_table_changed() {
+    if (!parsed_) {
+        return true;
+    }
+    // The kernel flags mountinfo with POLLPRI|POLLERR after any mount/umount
+    struct pollfd pfd;
+    pfd.fd = reader_.fd();
+    pfd.events = POLLPRI;
+    pfd.revents = 0;
+    if (pfd.fd < 0) {
+        return true;
+    }
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLPRI | POLLERR));
+}
+
+void FilesystemCollector::parse_mount_table() {
+    if (!reader_.read()) {
+        return;
+    }
+    parses_++;
+    parsed_ = true;
+    filesystems_.clear();
+    statvfs_paths_.clear();
+
+    std::set<std::string> seen_devices;  // Report bind mounts only once
+    const char* p = reader_.data();
+    const char* end = p + reader_.size();
+
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+
+        // Split into space-separated fields
+        std::vector<std::pair<const char*, const char*>> fields;
+        const char* f = p;
+        while (f < line_end) {
+            const char* sp = static_cast<const char*>(std::memchr(f, ' ', line_end - f));
+            if (!sp) sp = line_end;
+            fields.emplace_back(f, sp);
+            f = sp + 1;
+        }
+
+        // id parent major:minor root mount_point options [optional...] - fstype source superopts
+        size_t sep = 6;
+        while (sep < fields.size() && !(fields[sep].second - fields[sep].first == 1 && *fields[sep].first == '-')) {
+            sep++;
+        }
+        if (sep + 2 < fields.size()) {
+            std::string dev_id(fields[2].first, fields[2].second);
+            std::string fs_type(fields[sep + 1].first, fields[sep + 1].second);
+            if (!is_pseudo_fs(fs_type) && seen_devices.insert(dev_id).second) {
+                FilesystemStats fs;
+                fs.mount_point = unescape_mount_field(fields[4].first, fields[4].second);
+                fs.fs_type = fs_type;
+                fs.device = unescape_mount_field(fields[sep + 2].first, fields[sep + 2].second);
+                fs.model = disk_model(sys_root_, dev_id);
+                filesystems_.push_back(fs);
+                statvfs_paths_.push_back(rootfs_ + fs.mount_point);
+            }
+        }
+
+        p = line_end + 1;
+    }
+}
+
+bool FilesystemCollector::collect() {
+    if (mount_table_changed()) {
+        parse_mount_table();
+    }
+    if (!parsed_) {
+        return false;
+    }
+
+    for (size_t i = 0; i < filesystems_.size(); ++i) {
+        FilesystemStats& fs = filesystems_[i];
+        struct statvfs st;
+        fs.ok = statvfs(statvfs_paths_[i].c_str(), &st) == 0;
+        if (!fs.ok) continue;
+        unsigned long long frsize = st.f_frsize ? st.f_frsize : st.f_bsize;
+        fs.total_bytes = (unsigned long long)st.f_blocks * frsize;
+        fs.free_bytes = (unsigned long long)st.f_bfree * frsize;
+        fs.available_bytes = (unsigned long long)st.f_bavail * frsize;
+        fs.used_bytes = fs.total_bytes - fs.free_bytes;
+        fs.inodes_total = st.f_files;
+        fs.inodes_free = st.f_ffree;
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#include "instance_set.h"
+
+InstanceSet::InstanceSet(const std::vector<std::string>& ids) {
+    for (const auto& id : ids) {
+        insert(id);
+    }
+}
+
+bool InstanceSet::insert(const std::string& id) {
+    if (!index_.emplace(id, slots_.size()).second) {
+        return false;
+    }
+    slots_.push_back(id);
+    live_.push_back(true);
+    return true;
+}
+
+bool InstanceSet::erase(const std::string& id) {
+    auto it = index_.find(id);
+    if (it == index_.end()) {
+        return false;
+    }
+    size_t slot = it->second;
+    index_.erase(it);
+    live_[slot] = false;
+    slots_[slot].clear();
+    // Amortized: each compaction removes at least as many tombstones as there are live ids
+    if (slots_.size() - index_.size() > index_.size()) {
+        compact();
+    }
+    return true;
+}
+
+std::vector<std::string> InstanceSet::to_vector() const {
+    return std::vector<std::string>(begin(), end());
+}
+
+void InstanceSet::compact() {
+    size_t out = 0;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (!live_[i]) continue;
+        if (out != i) {
+            slots_[out] = std::move(slots_[i]);
+            index_[slots_[out]] = out;
+        }
+        ++out;
+    }
+    slots_.resize(out);
+    live_.assign(out, true);
+}
@@ -4,18 +4,29 @@
 #include <chrono>
 #include <sstream>
 #include <algorithm>
+#include <cstdlib>
+#include <grp.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "httplib.h"
 #include "system_info.h"
 #include "system_status.h"
 #include "device_config.h"
+#include "json_utils.h"
 #include "config.h"
+#include "status_sampler.h"
+#include "statsd_exporter.h"
+#include "shm_publisher.h"
+#include "psi_stats.h"
+#include "topology.h"
+#include "proc_reader.h"
 
 using namespace httplib;
 
 // Helper function to enable CORS
 void enable_cors(Response& res) {
     res.set_header("Access-Control-Allow-Origin", "*");
-    res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+    res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
     res.set_header("Access-Control-Allow-Headers", "Content-Type");
 }
 
@@ -38,6 +49,8 @@ void handle_system_status(const Request& req, Response& res) {
     enable_cors(res);
     res.set_header("Content-Type", "application/json");
     
+    // Someone is watching: keep the background sampler at its fastest rate for a while
+    note_status_sample_demand();
     try {
         std::string json_status = get_system_status_json();
         res.set_content(json_status, "application/json");
@@ -47,13 +60,120 @@ void handle_system_status(const Request& req, Response& res) {
     }
 }
 
+// GET /v1/core/system/processes?top=20&sort=cpu - Top processes by CPU or memory
+void handle_system_processes(const Request& req, Response& res) {
+    enable_cors(res);
+    res.set_header("Content-Type", "application/json");
+    
+    try {
+        int top_n = 20;
+        if (req.has_param("top")) {
+            top_n = std::atoi(req.get_param_value("top").c_str());
+            if (top_n <= 0 || top_n > 1000) {
+                res.status = 400;
+                res.set_content(R"({"error": "Bad Request", "message": "top must be between 1 and 1000"})", "application/json");
+                return;
+            }
+        }
+        ProcessSortKey sort_key;
+        if (!parse_process_sort_key(req.get_param_value("sort"), sort_key)) {
+            res.status = 400;
+            res.set_content(R"({"error": "Bad Request", "message": "sort must be cpu or memory"})", "application/json");
+            return;
+        }
+        res.set_content(get_process_table_json((size_t)top_n, sort_key), "application/json");
+    } catch (const std::exception& e) {
+        res.status = 500;
+        res.set_content(R"({"error": "Failed to get process table", "message": ")" + std::string(e.what()) + "\"}", "application/json");
+    }
+}
+
+// GET /v1/core/instances/{id}/metrics - CPU/RSS/IO of the processes bound to an instance
+void handle_instance_metrics(const Request& req, Response& res) {
+    enable_cors(res);
+    res.set_header("Content-Type", "application/json");
+    
+    try {
+        std::string instance_id = req.matches[1];
+        std::string json_metrics;
+        if (!get_instance_metrics_json(instance_id, json_metrics)) {
+            res.status = 404;
+            res.set_content(R"({"error": "Not Found", "message": "No process binding configured for this instance"})", "application/json");
+            return;
+        }
+        res.set_content(json_metrics, "application/json");
+    } catch (const std::exception& e) {
+        res.status = 500;
+        res.set_content(R"({"error": "Failed to get instance metrics", "message": ")" + std::string(e.what()) + "\"}", "application/json");
+    }
+}
+
+// Global config (loaded at startup)
+static AppConfig g_app_config;
+
+// Check Basic Authentication (with explicit credentials)
+static bool check_basic_auth_impl(const Request& req, const std::string& username, const std::string& password) {
+    auto auth_header = req.get_header_value("Authorization");
+    if (auth_header.empty()) {
+        return false;
+    }
+    
+    // Check if it's Basic auth
+    if (auth_header.find("Basic ") != 0) {
+        return false;
+    }
+    
+    // Decode base64 (simple implementation)
+    std::string encoded = auth_header.substr(6); // Skip "Basic "
+    
+    // Remove whitespace
+    encoded.erase(std::remove(encoded.begin(), encoded.end(), ' '), encoded.end());
+    encoded.erase(std::remove(encoded.begin(), encoded.end(), '\n'), encoded.end());
+    encoded.erase(std::remove(encoded.begin(), encoded.end(), '\r'), encoded.end());
+    
+    // For simplicity, we'll use a basic base64 decode
+    // In production, use a proper base64 library
+    std::string decoded;
+    const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    
+    int val = 0, valb = -8;
+    for (size_t i = 0; i < encoded.length(); i++) {
+        char c = encoded[i];
+        if (c == '=') break;
+        size_t idx = chars.find(c);
+        if (idx == std::string::npos) continue;
+        val = (val << 6) + idx;
+        valb += 6;
+        if (valb >= 0) {
+            decoded.push_back(char((val >> valb) & 0xFF));
+            valb -= 8;
+        }
+    }
+    
+    // Check format: username:password
+    size_t colon_pos = decoded.find(':');
+    if (colon_pos == std::string::npos) {
+        return false;
+    }
+    
+    std::string req_username = decoded.substr(0, colon_pos);
+    std::string req_password = decoded.substr(colon_pos + 1);
+    
+    return (req_username == username && req_password == password);
+}
+
 // POST /v1/core/system/reboot - Reboots the system
 void handle_system_reboot(const Request& req, Response& res) {
     enable_cors(res);
     res.set_header("Content-Type", "application/json");
     
-    // Check if user has permission (in production, add authentication)
-    // For now, we'll just return a message. Uncomment the actual reboot code if needed.
+    // Same credentials as device registration
+    if (!check_basic_auth_impl(req, g_app_config.authentication.username, g_app_config.authentication.password)) {
+        res.status = 401;
+        res.set_header("WWW-Authenticate", "Basic realm=\"Device Registration\"");
+        res.set_content(R"({"error": "Unauthorized", "message": "Invalid credentials"})", "application/json");
+        return;
+    }
     
     try {
         // Return success message
@@ -77,6 +197,14 @@ void handle_firmware_command(const Request& req, Response& res) {
     enable_cors(res);
     res.set_header("Content-Type", "application/json");
 
+    // The URL below ends up in a shell command run as root
+    if (!check_basic_auth_impl(req, g_app_config.authentication.username, g_app_config.authentication.password)) {
+        res.status = 401;
+        res.set_header("WWW-Authenticate", "Basic realm=\"Device Registration\"");
+        res.set_content(R"({"error": "Unauthorized", "message": "Invalid credentials"})", "application/json");
+        return;
+    }
+
     try {
         std::string json_body = req.body;
         if (json_body.empty()) {
@@ -184,60 +312,6 @@ void handle_options(const Request& req, Response& res) {
     res.status = 200;
 }
 
-// Global config (loaded at startup)
-static AppConfig g_app_config;
-
-// Check Basic Authentication (with explicit credentials)
-static bool check_basic_auth_impl(const Request& req, const std::string& username, const std::string& password) {
-    auto auth_header = req.get_header_value("Authorization");
-    if (auth_header.empty()) {
-        return false;
-    }
-    
-    // Check if it's Basic auth
-    if (auth_header.find("Basic ") != 0) {
-        return false;
-    }
-    
-    // Decode base64 (simple implementation)
-    std::string encoded = auth_header.substr(6); // Skip "Basic "
-    
-    // Remove whitespace
-    encoded.erase(std::remove(encoded.begin(), encoded.end(), ' '), encoded.end());
-    encoded.erase(std::remove(encoded.begin(), encoded.end(), '\n'), encoded.end());
-    encoded.erase(std::remove(encoded.begin(), encoded.end(), '\r'), encoded.end());
-    
-    // For simplicity, we'll use a basic base64 decode
-    // In production, use a proper base64 library
-    std::string decoded;
-    const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    
-    int val = 0, valb = -8;
-    for (size_t i = 0; i < encoded.length(); i++) {
-        char c = encoded[i];
-        if (c == '=') break;
-        size_t idx = chars.find(c);
-        if (idx == std::string::npos) continue;
-        val = (val << 6) + idx;
-        valb += 6;
-        if (valb >= 0) {
-            decoded.push_back(char((val >> valb) & 0xFF));
-            valb -= 8;
-        }
-    }
-    
-    // Check format: username:password
-    size_t colon_pos = decoded.find(':');
-    if (colon_pos == std::string::npos) {
-        return false;
-    }
-    
-    std::string req_username = decoded.substr(0, colon_pos);
-    std::string req_password = decoded.substr(colon_pos + 1);
-    
-    return (req_username == username && req_password == password);
-}
-
 // POST /v1/core/system/info - Register/Update device information
 void handle_post_system_info(const Request& req, Response& res) {
     enable_cors(res);
@@ -278,10 +352,6 @@ void handle_post_system_info(const Request& req, Response& res) {
             return;
         }
         
-        // Reload config from file to ensure memory is updated
-        // This ensures subsequent GET requests will return the saved values
-        reload_device_config();
-        
         // Return success response
         res.status = 200;
         res.set_content(R"({"status": "success", "message": "Device information registered successfully"})", "application/json");
@@ -292,6 +362,122 @@ void handle_post_system_info(const Request& req, Response& res) {
     }
 }
 
+// PUT/DELETE /v1/core/instances/{id} - Register or unregister one instance
+static void handle_instance_change(const Request& req, Response& res, bool add) {
+    enable_cors(res);
+    res.set_header("Content-Type", "application/json");
+    
+    // Same credentials as device registration
+    if (!check_basic_auth_impl(req, g_app_config.authentication.username, g_app_config.authentication.password)) {
+        res.status = 401;
+        res.set_header("WWW-Authenticate", "Basic realm=\"Device Registration\"");
+        res.set_content(R"({"error": "Unauthorized", "message": "Invalid credentials"})", "application/json");
+        return;
+    }
+    
+    try {
+        std::string instance_id = req.matches[1];
+        if (!is_valid_instance_id(instance_id)) {
+            res.status = 400;
+            res.set_content(R"({"error": "Bad Request", "message": "Invalid instance id"})", "application/json");
+            return;
+        }
+        
+        bool changed = false;
+        bool ok = add ? add_device_instance(instance_id, changed) : remove_device_instance(instance_id, changed);
+        if (!ok) {
+            res.status = 500;
+            res.set_content(R"({"error": "Internal Server Error", "message": "Failed to save instances"})", "application/json");
+            return;
+        }
+        if (!add && !changed) {
+            res.status = 404;
+            res.set_content(R"({"error": "Not Found", "message": "Instance is not registered"})", "application/json");
+            return;
+        }
+        
+        // 201 for a new registration, 200 when it already existed or was removed
+        res.status = add && changed ? 201 : 200;
+        std::ostringstream json;
+        json << "{\"status\": \"success\", \"instance\": \"" << escape_json(instance_id) << "\", "
+             << "\"instances\": " << get_device_state()->instances.size() << "}";
+        res.set_content(json.str(), "application/json");
+    } catch (const std::exception& e) {
+        res.status = 500;
+        res.set_content(R"({"error": "Internal Server Error", "message": ")" + std::string(e.what()) + "\"}", "application/json");
+    }
+}
+
+void handle_put_instance(const Request& req, Response& res) {
+    handle_instance_change(req, res, true);
+}
+
+void handle_delete_instance(const Request& req, Response& res) {
+    handle_instance_change(req, res, false);
+}
+
+// Register all API routes on a server (shared by the TCP and Unix socket listeners)
+static void register_routes(Server& svr) {
+    // API endpoints
+    svr.Get("/v1/core/system/info", handle_system_info);
+    svr.Post("/v1/core/system/info", handle_post_system_info);
+    svr.Get("/v1/core/system/status", handle_system_status);
+    svr.Post("/v1/core/system/reboot", handle_system_reboot);
+    svr.Post("/v1/core/firmware/command", handle_firmware_command);
+    svr.Get("/v1/core/system/processes", handle_system_processes);
+    svr.Get(R"(/v1/core/instances/([^/]+)/metrics)", handle_instance_metrics);
+    svr.Put(R"(/v1/core/instances/([^/]+))", handle_put_instance);
+    svr.Delete(R"(/v1/core/instances/([^/]+))", handle_delete_instance);
+    svr.Options("/v1/core/system/.*", handle_options);
+    svr.Options("/v1/core/instances/.*", handle_options);
+    
+    // Health check endpoint
+    svr.Get("/health", [](const Request& req, Response& res) {
+        res.set_content(R"({"status": "ok"})", "application/json");
+    });
+    
+    // Root endpoint
+    svr.Get("/", [](const Request& req, Response& res) {
+        std::ostringstream json;
+        json << "{\"service\": \"Metrics Monitor System\", \"version\": \"1.0.0\", \"endpoints\": {";
+        json << "\"system_info\": \"GET /v1/core/system/info\", ";
+        json << "\"system_info_register\": \"POST /v1/core/system/info (Basic Auth required)\", ";
+        json << "\"system_status\": \"GET /v1/core/system/status\", ";
+        json << "\"system_processes\": \"GET /v1/core/system/processes?top=20&sort=cpu\", ";
+        json << "\"instance_metrics\": \"GET /v1/core/instances/{id}/metrics\", ";
+        json << "\"instance_register\": \"PUT /v1/core/instances/{id} (Basic Auth required)\", ";
+        json << "\"instance_unregister\": \"DELETE /v1/core/instances/{id} (Basic Auth required)\", ";
+        json << "\"system_reboot\": \"POST /v1/core/system/reboot (Basic Auth required)\", ";
+        json << "\"firmware_command\": \"POST /v1/core/firmware/command (Basic Auth required)\"}}";
+        res.set_content(json.str(), "application/json");
+    });
+}
+
+// Bind a Unix domain socket, replacing a stale socket file from a previous run
+static bool bind_unix_socket(Server& svr, const std::string& path, const ServerConfig& server) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path.c_str());
+    }
+    
+    svr.set_address_family(AF_UNIX);
+    if (!svr.bind_to_port(path, 80)) {
+        std::cerr << "Failed to bind unix:" << path << std::endl;
+        return false;
+    }
+    
+    // Anyone who can connect reaches every endpoint (GET needs no auth), so the socket is
+    // owner/group only by default; put co-located instances' users in unix_socket_group
+    if (!server.unix_socket_group.empty()) {
+        struct group* grp = getgrnam(server.unix_socket_group.c_str());
+        if (grp == nullptr || chown(path.c_str(), static_cast<uid_t>(-1), grp->gr_gid) != 0) {
+            std::cerr << "Failed to set group " << server.unix_socket_group << " on unix:" << path << std::endl;
+        }
+    }
+    chmod(path.c_str(), static_cast<mode_t>(server.unix_socket_mode));
+    return true;
+}
+
 int main(int argc, char** argv) {
     // Load configuration
     std::string config_path = "./config.json";
@@ -321,33 +507,50 @@ int main(int argc, char** argv) {
     }
     
     std::cout << "Loading configuration from: " << config_path << std::endl;
-    std::cout << "Server will listen on: " << g_app_config.server.host << ":" << g_app_config.server.port << std::endl;
-    
-    Server svr;
+    if (!g_app_config.server.host.empty()) {
+        std::cout << "Server will listen on: " << g_app_config.server.host << ":" << g_app_config.server.port << std::endl;
+    }
+    if (!g_app_config.server.unix_socket.empty()) {
+        std::cout << "Server will listen on: unix:" << g_app_config.server.unix_socket << std::endl;
+    }
     
-    // API endpoints
-    svr.Get("/v1/core/system/info", handle_system_info);
-    svr.Post("/v1/core/system/info", handle_post_system_info);
-    svr.Get("/v1/core/system/status", handle_system_status);
-    svr.Post("/v1/core/system/reboot", handle_system_reboot);
-    svr.Post("/v1/core/firmware/command", handle_firmware_command);
-    svr.Options("/v1/core/system/.*", handle_options);
+    // Every collector builds its paths from these roots; set them before any is created
+    set_host_paths(g_app_config.host_paths.proc, g_app_config.host_paths.sys, g_app_config.host_paths.rootfs);
+    if (host_proc_root() != "/proc" || host_sys_root() != "/sys" || !host_rootfs().empty()) {
+        std::cout << "Host paths: proc=" << host_proc_root() << " sys=" << host_sys_root()
+                  << " rootfs=" << (host_rootfs().empty() ? "/" : host_rootfs()) << std::endl;
+    }
+    configure_system_status(g_app_config);
+    // Topology only changes with CPU hotplug; read sysfs once before serving
+    const CpuTopology& topology = get_cpu_topology();
+    std::cout << "CPU topology: " << topology.packages << " package(s), " << topology.cores << " core(s), "
+              << topology.cpus.size() << " CPU(s), " << topology.nodes.size() << " NUMA node(s)" << std::endl;
     
-    // Health check endpoint
-    svr.Get("/health", [](const Request& req, Response& res) {
-        res.set_content(R"({"status": "ok"})", "application/json");
-    });
+    // Load the registration once; afterwards the watcher reloads it when the file changes
+    load_device_config();
+    if (!start_device_config_watcher()) {
+        std::cerr << "Warning: device config watcher not running; external edits of device_registered.json need a restart" << std::endl;
+    }
     
-    // Root endpoint
-    svr.Get("/", [](const Request& req, Response& res) {
-        std::ostringstream json;
-        json << "{\"service\": \"Metrics Monitor System\", \"version\": \"1.0.0\", \"endpoints\": {";
-        json << "\"system_info\": \"GET /v1/core/system/info\", ";
-        json << "\"system_info_register\": \"POST /v1/core/system/info (Basic Auth required)\", ";
-        json << "\"system_status\": \"GET /v1/core/system/status\", ";
-        json << "\"system_reboot\": \"POST /v1/core/system/reboot\"}}";
-        res.set_content(json.str(), "application/json");
+    // Background sampling and push exporters run independently of HTTP requests
+    start_status_collectors();
+    if (g_app_config.shm.enabled && open_metrics_shm(g_app_config.shm.name)) {
+        add_status_sample_listener(publish_metrics_shm);
+        std::cout << "Shared-memory snapshot: " << g_app_config.shm.name << std::endl;
+    }
+    start_status_sampler(g_app_config.sampler);
+    int psi_triggers = start_psi_trigger_watcher(g_app_config.psi.triggers, [](const std::string&) {
+        // Stall event: sample immediately instead of waiting for the next period
+        request_status_sample();
     });
+    if (psi_triggers > 0) {
+        std::cout << "PSI triggers armed: " << psi_triggers << std::endl;
+    }
+    start_statsd_exporter(g_app_config.statsd);
+    if (g_app_config.statsd.enabled) {
+        std::cout << "StatsD exporter: " << g_app_config.statsd.host << ":" << g_app_config.statsd.port
+                  << " every " << g_app_config.statsd.interval_ms << " ms" << std::endl;
+    }
     
     std::cout << "Server starting..." << std::endl;
     std::cout << "API endpoints:" << std::endl;
@@ -357,14 +560,57 @@ int main(int argc, char** argv) {
               << g_app_config.authentication.password << ")" << std::endl;
     std::cout << "  GET  /v1/core/system/status" << std::endl;
     std::cout << "  POST /v1/core/system/reboot" << std::endl;
+    std::cout << "  PUT  /v1/core/instances/{id} (Basic Auth)" << std::endl;
+    std::cout << "  DELETE /v1/core/instances/{id} (Basic Auth)" << std::endl;
     std::cout << "  GET  /health" << std::endl;
     
-    if (!svr.listen(g_app_config.server.host.c_str(), g_app_config.server.port)) {
+    const std::string& unix_socket = g_app_config.server.unix_socket;
+    bool use_tcp = !g_app_config.server.host.empty();
+    bool use_unix = !unix_socket.empty();
+    bool ok = true;
+    
+    Server svr;
+    Server unix_svr;
+    register_routes(svr);
+    
+    if (use_tcp && use_unix) {
+        // Serve the same routes on the Unix socket from a second listener thread
+        register_routes(unix_svr);
+        std::thread unix_thread;
+        if (bind_unix_socket(unix_svr, unix_socket, g_app_config.server)) {
+            unix_thread = std::thread([&unix_svr]() { unix_svr.listen_after_bind(); });
+        }
+        
+        if (!svr.listen(g_app_config.server.host.c_str(), g_app_config.server.port)) {
+            std::cerr << "Failed to start server on " << g_app_config.server.host 
+                      << ":" << g_app_config.server.port << std::endl;
+            ok = false;
+        }
+        
+        if (unix_thread.joinable()) {
+            unix_svr.wait_until_ready();
+            unix_svr.stop();
+            unix_thread.join();
+            unlink(unix_socket.c_str());
+        }
+    } else if (use_unix) {
+        if (!bind_unix_socket(svr, unix_socket, g_app_config.server) || !svr.listen_after_bind()) {
+            std::cerr << "Failed to start server on unix:" << unix_socket << std::endl;
+            ok = false;
+        }
+        unlink(unix_socket.c_str());
+    } else if (!svr.listen(g_app_config.server.host.c_str(), g_app_config.server.port)) {
         std::cerr << "Failed to start server on " << g_app_config.server.host 
                   << ":" << g_app_config.server.port << std::endl;
-        return 1;
+        ok = false;
     }
     
-    return 0;
+    stop_psi_trigger_watcher();
+    stop_device_config_watcher();
+    stop_statsd_exporter();
+    stop_status_collectors();
+    stop_status_sampler();
+    close_metrics_shm();
+    return ok ? 0 : 1;
 }
 
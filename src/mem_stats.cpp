@@ -0,0 +1,229 @@
+#include "mem_stats.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+struct SlotKey {
+    const char* key;
+    int slot;
+};
+
+static const SlotKey kMeminfoKeys[] = {
+    {"MemTotal", kMemTotal},
+    {"MemFree", kMemFree},
+    {"MemAvailable", kMemAvailable},
+    {"Buffers", kMemBuffers},
+    {"Cached", kMemCached},
+    {"SwapCached", kMemSwapCached},
+    {"Active", kMemActive},
+    {"Inactive", kMemInactive},
+    {"Dirty", kMemDirty},
+    {"Writeback", kMemWriteback},
+    {"AnonPages", kMemAnonPages},
+    {"Mapped", kMemMapped},
+    {"Shmem", kMemShmem},
+    {"Slab", kMemSlab},
+    {"SReclaimable", kMemSReclaimable},
+    {"SUnreclaim", kMemSUnreclaim},
+    {"SwapTotal", kMemSwapTotal},
+    {"SwapFree", kMemSwapFree},
+    {"CommitLimit", kMemCommitLimit},
+    {"Committed_AS", kMemCommittedAs},
+};
+
+// Kernels before 4.8/5.9 report some counters as one line, newer ones per zone or LRU
+static const SlotKey kVmstatKeys[] = {
+    {"pgpgin", kVmPgpgin},
+    {"pgpgout", kVmPgpgout},
+    {"pswpin", kVmPswpin},
+    {"pswpout", kVmPswpout},
+    {"pgfault", kVmPgfault},
+    {"pgmajfault", kVmPgmajfault},
+    {"pgscan_kswapd", kVmPgscanKswapd},
+    {"pgscan_direct", kVmPgscanDirect},
+    {"pgsteal_kswapd", kVmPgstealKswapd},
+    {"pgsteal_direct", kVmPgstealDirect},
+    {"allocstall", kVmAllocstall},
+    {"allocstall_dma", kVmAllocstall},
+    {"allocstall_dma32", kVmAllocstall},
+    {"allocstall_normal", kVmAllocstall},
+    {"allocstall_movable", kVmAllocstall},
+    {"allocstall_device", kVmAllocstall},
+    {"workingset_refault", kVmWorkingsetRefault},
+    {"workingset_refault_anon", kVmWorkingsetRefault},
+    {"workingset_refault_file", kVmWorkingsetRefault},
+    {"compact_stall", kVmCompactStall},
+    {"oom_kill", kVmOomKill},
+};
+
+static const char* const kMeminfoFieldNames[kMeminfoFieldCount] = {
+    "total", "free", "available", "buffers", "cached", "swap_cached", "active", "inactive",
+    "dirty", "writeback", "anon", "mapped", "shmem", "slab", "slab_reclaimable",
+    "slab_unreclaimable", "swap_total", "swap_free", "commit_limit", "committed_as",
+};
+
+static const char* const kVmstatFieldNames[kVmstatFieldCount] = {
+    "pgpgin", "pgpgout", "pswpin", "pswpout", "pgfault", "pgmajfault", "pgscan_kswapd",
+    "pgscan_direct", "pgsteal_kswapd", "pgsteal_direct", "allocstall", "workingset_refault",
+    "compact_stall", "oom_kill",
+};
+
+static const size_t kHashBuckets = 64;  // Power of two, well above either key count
+static const uint8_t kEmptyBucket = 0xFF;
+
+/**
+ * Collision-free bucket table for a fixed key set: the seed is searched once
+ * so every known key lands in its own bucket, and a lookup is one hash plus
+ * one memcmp against the key stored there
+ */
+struct PerfectHash {
+    uint32_t seed = 0;
+    uint8_t buckets[kHashBuckets];
+    uint8_t key_lengths[kHashBuckets];
+};
+
+static uint32_t hash_key(const char* key, size_t len, uint32_t seed) {
+    // FNV-1a with the seed folded into the offset basis, plus a final mix for the low bits
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (uint8_t)key[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    return h;
+}
+
+static PerfectHash build_perfect_hash(const SlotKey* keys, size_t count) {
+    PerfectHash table;
+    for (uint32_t seed = 1; seed != 0; ++seed) {
+        std::memset(table.buckets, kEmptyBucket, sizeof(table.buckets));
+        bool collision = false;
+        for (size_t i = 0; i < count && !collision; ++i) {
+            size_t len = std::strlen(keys[i].key);
+            size_t bucket = hash_key(keys[i].key, len, seed) & (kHashBuckets - 1);
+            collision = table.buckets[bucket] != kEmptyBucket;
+            table.buckets[bucket] = (uint8_t)i;
+            table.key_lengths[bucket] = (uint8_t)len;
+        }
+        if (!collision) {
+            table.seed = seed;
+            break;
+        }
+    }
+    return table;
+}
+
+// Index into keys, -1 for keys that are not tracked
+static int lookup_key(const PerfectHash& table, const SlotKey* keys, const char* key, size_t len) {
+    size_t bucket = hash_key(key, len, table.seed) & (kHashBuckets - 1);
+    uint8_t index = table.buckets[bucket];
+    if (index == kEmptyBucket || table.key_lengths[bucket] != len ||
+        std::memcmp(keys[index].key, key, len) != 0) {
+        return -1;
+    }
+    return index;
+}
+
+static const PerfectHash& meminfo_hash() {
+    static const PerfectHash table =
+        build_perfect_hash(kMeminfoKeys, sizeof(kMeminfoKeys) / sizeof(kMeminfoKeys[0]));
+    return table;
+}
+
+static const PerfectHash& vmstat_hash() {
+    static const PerfectHash table =
+        build_perfect_hash(kVmstatKeys, sizeof(kVmstatKeys) / sizeof(kVmstatKeys[0]));
+    return table;
+}
+
+bool parse_meminfo(const char* text, MeminfoValues& out) {
+    const PerfectHash& table = meminfo_hash();
+    out = MeminfoValues();
+    const char* p = text;
+    while (*p) {
+        // "MemTotal:       16318432 kB"
+        const char* colon = std::strchr(p, ':');
+        if (!colon) break;
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(colon + 1, &end, 10);
+        int index = lookup_key(table, kMeminfoKeys, p, colon - p);
+        if (index >= 0) {
+            while (*end == ' ') ++end;
+            int slot = kMeminfoKeys[index].slot;
+            out.bytes[slot] = end[0] == 'k' && end[1] == 'B' ? value * 1024 : value;
+            out.present[slot] = true;
+        }
+        p = std::strchr(end ? end : colon, '\n');
+        if (!p) break;
+        ++p;
+    }
+    return out.present[kMemTotal];
+}
+
+bool parse_vmstat(const char* text, VmstatValues& out) {
+    const PerfectHash& table = vmstat_hash();
+    out = VmstatValues();
+    bool any = false;
+    const char* p = text;
+    while (*p) {
+        // "pgmajfault 1234"
+        const char* space = std::strchr(p, ' ');
+        if (!space) break;
+        const char* eol = std::strchr(p, '\n');
+        if (eol && eol < space) {
+            p = eol + 1;
+            continue;
+        }
+        int index = lookup_key(table, kVmstatKeys, p, space - p);
+        if (index >= 0) {
+            int slot = kVmstatKeys[index].slot;
+            out.counts[slot] += std::strtoull(space + 1, nullptr, 10);
+            out.present[slot] = true;
+            any = true;
+        }
+        if (!eol) break;
+        p = eol + 1;
+    }
+    return any;
+}
+
+const char* meminfo_field_name(MeminfoField field) {
+    return kMeminfoFieldNames[field];
+}
+
+const char* vmstat_field_name(VmstatField field) {
+    return kVmstatFieldNames[field];
+}
+
+MemoryCollector::MemoryCollector(const std::string& proc_root)
+    : meminfo_reader_(proc_root + "/meminfo"),
+      vmstat_reader_(proc_root + "/vmstat"),
+      has_collected_(false) {
+    for (double& rate : rates_) rate = -1;
+}
+
+bool MemoryCollector::collect() {
+    bool ok = meminfo_reader_.read() && parse_meminfo(meminfo_reader_.data(), meminfo_);
+
+    auto now = std::chrono::steady_clock::now();
+    VmstatValues previous = vmstat_;
+    if (!vmstat_reader_.read() || !parse_vmstat(vmstat_reader_.data(), vmstat_)) {
+        for (double& rate : rates_) rate = -1;
+        has_collected_ = false;
+        return ok;
+    }
+
+    double elapsed = has_collected_ ? std::chrono::duration<double>(now - last_collect_).count() : 0;
+    for (int i = 0; i < kVmstatFieldCount; ++i) {
+        if (elapsed <= 0 || !vmstat_.present[i]) {
+            rates_[i] = -1;
+        } else if (vmstat_.counts[i] < previous.counts[i]) {
+            rates_[i] = 0;
+        } else {
+            rates_[i] = (vmstat_.counts[i] - previous.counts[i]) / elapsed;
+        }
+    }
+    last_collect_ = now;
+    has_collected_ = true;
+    return ok;
+}
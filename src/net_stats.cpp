@@ -0,0 +1,362 @@
+#include "net_stats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+NetDevCollector::NetDevCollector(const std::string& path)
+    : reader_(path), has_previous_(false) {
+    slots_.reserve(16);
+    line_slots_.reserve(16);
+}
+
+// Interfaces are listed in a stable order, so the slot used by the same line
+// last time is almost always a hit; fall back to a scan, then a new slot
+size_t NetDevCollector::slot_for(const char* name, size_t len, size_t line_index) {
+    if (line_index < line_slots_.size()) {
+        const std::string& hint = slots_[line_slots_[line_index]].name;
+        if (hint.size() == len && std::memcmp(hint.data(), name, len) == 0) {
+            return line_slots_[line_index];
+        }
+    }
+
+    size_t slot = slots_.size();
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].name.size() == len && std::memcmp(slots_[i].name.data(), name, len) == 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == slots_.size()) {
+        slots_.emplace_back();
+        slots_.back().name.assign(name, len);
+    }
+
+    if (line_index < line_slots_.size()) {
+        line_slots_[line_index] = slot;
+    } else {
+        line_slots_.push_back(slot);
+    }
+    return slot;
+}
+
+static double counter_rate(unsigned long long prev, unsigned long long cur, double seconds) {
+    // A counter going backwards means the interface was reset or recreated
+    if (cur < prev || seconds <= 0) return 0.0;
+    return (double)(cur - prev) / seconds;
+}
+
+bool NetDevCollector::collect() {
+    if (!reader_.read()) {
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = has_previous_ ? std::chrono::duration<double>(now - last_time_).count() : 0.0;
+
+    // Every existing slot was present last pass (see below); new slots get no rate yet
+    size_t previous_slots = slots_.size();
+    for (auto& slot : slots_) {
+        slot.present = false;
+    }
+
+    const char* p = reader_.data();
+    const char* end = p + reader_.size();
+
+    // Skip the two header lines
+    for (int header = 0; header < 2 && p < end; ++header) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = nl ? nl + 1 : end;
+    }
+
+    size_t line_index = 0;
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+
+        while (p < line_end && *p == ' ') ++p;
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', line_end - p));
+        if (colon && colon > p) {
+            // 8 receive columns, then 8 transmit columns
+            unsigned long long v[16] = {};
+            char* cursor = const_cast<char*>(colon + 1);
+            for (int i = 0; i < 16 && cursor < line_end; ++i) {
+                v[i] = std::strtoull(cursor, &cursor, 10);
+            }
+
+            size_t slot = slot_for(p, colon - p, line_index);
+            NetInterfaceStats& s = slots_[slot];
+            if (slot < previous_slots) {
+                s.rx_bytes_per_sec = counter_rate(s.rx_bytes, v[0], seconds);
+                s.rx_packets_per_sec = counter_rate(s.rx_packets, v[1], seconds);
+                s.rx_errors_per_sec = counter_rate(s.rx_errors, v[2], seconds);
+                s.rx_dropped_per_sec = counter_rate(s.rx_dropped, v[3], seconds);
+                s.tx_bytes_per_sec = counter_rate(s.tx_bytes, v[8], seconds);
+                s.tx_packets_per_sec = counter_rate(s.tx_packets, v[9], seconds);
+                s.tx_errors_per_sec = counter_rate(s.tx_errors, v[10], seconds);
+                s.tx_dropped_per_sec = counter_rate(s.tx_dropped, v[11], seconds);
+            }
+            s.rx_bytes = v[0];
+            s.rx_packets = v[1];
+            s.rx_errors = v[2];
+            s.rx_dropped = v[3];
+            s.tx_bytes = v[8];
+            s.tx_packets = v[9];
+            s.tx_errors = v[10];
+            s.tx_dropped = v[11];
+            s.present = true;
+            ++line_index;
+        }
+
+        p = line_end + 1;
+    }
+
+    // Drop interfaces missing for this whole pass (veth pairs of stopped
+    // containers, PPP links) so the slots do not grow without bound
+    if (std::any_of(slots_.begin(), slots_.end(), [](const NetInterfaceStats& s) { return !s.present; })) {
+        std::vector<size_t> remap(slots_.size());
+        size_t kept = 0;
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            remap[i] = kept;
+            if (!slots_[i].present) continue;
+            if (kept != i) slots_[kept] = std::move(slots_[i]);
+            ++kept;
+        }
+        slots_.resize(kept);
+        // Hints past this pass's last line may name dropped slots
+        line_slots_.resize(std::min(line_slots_.size(), line_index));
+        for (auto& slot : line_slots_) {
+            slot = remap[slot];
+        }
+    }
+
+    last_time_ = now;
+    has_previous_ = true;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// /proc/net/snmp, /proc/net/netstat and sockstat
+
+struct NetProtoColumn {
+    const char* prefix;         // "Tcp", "TcpExt", "Udp"
+    const char* column;
+    int counter;
+};
+
+static const NetProtoColumn kNetProtoColumns[] = {
+    {"Tcp", "ActiveOpens", kTcpActiveOpens},
+    {"Tcp", "PassiveOpens", kTcpPassiveOpens},
+    {"Tcp", "AttemptFails", kTcpAttemptFails},
+    {"Tcp", "EstabResets", kTcpEstabResets},
+    {"Tcp", "CurrEstab", kTcpCurrEstab},
+    {"Tcp", "InSegs", kTcpInSegs},
+    {"Tcp", "OutSegs", kTcpOutSegs},
+    {"Tcp", "RetransSegs", kTcpRetransSegs},
+    {"Tcp", "InErrs", kTcpInErrs},
+    {"Tcp", "OutRsts", kTcpOutRsts},
+    {"TcpExt", "ListenOverflows", kTcpListenOverflows},
+    {"TcpExt", "ListenDrops", kTcpListenDrops},
+    {"TcpExt", "TCPTimeouts", kTcpTimeouts},
+    {"TcpExt", "TCPLostRetransmit", kTcpLostRetransmit},
+    {"TcpExt", "TCPBacklogDrop", kTcpBacklogDrop},
+    {"TcpExt", "TCPAbortOnMemory", kTcpAbortOnMemory},
+    {"Udp", "InDatagrams", kUdpInDatagrams},
+    {"Udp", "NoPorts", kUdpNoPorts},
+    {"Udp", "InErrors", kUdpInErrors},
+    {"Udp", "OutDatagrams", kUdpOutDatagrams},
+    {"Udp", "RcvbufErrors", kUdpRcvbufErrors},
+    {"Udp", "SndbufErrors", kUdpSndbufErrors},
+};
+
+static const char* const kNetProtoCounterNames[kNetProtoCounterCount] = {
+    "active_opens", "passive_opens", "attempt_fails", "estab_resets", "curr_estab",
+    "in_segs", "out_segs", "retrans_segs", "in_errs", "out_rsts", "listen_overflows",
+    "listen_drops", "timeouts", "lost_retransmit", "backlog_drop", "abort_on_memory",
+    "in_datagrams", "no_ports", "in_errors", "out_datagrams", "rcvbuf_errors", "sndbuf_errors",
+};
+
+const char* NetProtoCollector::counter_name(NetProtoCounter counter) {
+    return kNetProtoCounterNames[counter];
+}
+
+const char* NetProtoCollector::counter_group(NetProtoCounter counter) {
+    return counter >= kUdpInDatagrams ? "udp" : "tcp";
+}
+
+bool NetProtoCollector::counter_is_gauge(NetProtoCounter counter) {
+    return counter == kTcpCurrEstab;
+}
+
+// Counter for "<prefix>: ... <column> ...", -1 if not tracked
+static int net_proto_slot(const char* prefix, size_t prefix_len, const char* column, size_t column_len) {
+    for (const auto& entry : kNetProtoColumns) {
+        if (std::strlen(entry.prefix) == prefix_len && std::memcmp(entry.prefix, prefix, prefix_len) == 0 &&
+            std::strlen(entry.column) == column_len && std::memcmp(entry.column, column, column_len) == 0) {
+            return entry.counter;
+        }
+    }
+    return -1;
+}
+
+bool parse_sockstat(const char* text, SockStat& out) {
+    struct Field {
+        const char* line;
+        const char* key;
+        long long SockStat::*member;
+    };
+    static const Field kFields[] = {
+        {"sockets", "used", &SockStat::sockets_used},
+        {"TCP", "inuse", &SockStat::tcp_inuse},
+        {"TCP", "orphan", &SockStat::tcp_orphan},
+        {"TCP", "tw", &SockStat::tcp_time_wait},
+        {"TCP", "alloc", &SockStat::tcp_alloc},
+        {"TCP", "mem", &SockStat::tcp_mem_pages},
+        {"UDP", "inuse", &SockStat::udp_inuse},
+        {"UDP", "mem", &SockStat::udp_mem_pages},
+        {"TCP6", "inuse", &SockStat::tcp6_inuse},
+        {"UDP6", "inuse", &SockStat::udp6_inuse},
+    };
+
+    bool any = false;
+    const char* p = text;
+    while (*p) {
+        // "TCP: inuse 5 orphan 0 tw 0 alloc 7 mem 1"
+        const char* eol = std::strchr(p, '\n');
+        const char* line_end = eol ? eol : p + std::strlen(p);
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', line_end - p));
+        if (colon) {
+            size_t name_len = colon - p;
+            const char* cursor = colon + 1;
+            while (cursor < line_end) {
+                while (cursor < line_end && *cursor == ' ') ++cursor;
+                const char* key = cursor;
+                while (cursor < line_end && *cursor != ' ') ++cursor;
+                size_t key_len = cursor - key;
+                char* next = nullptr;
+                long long value = std::strtoll(cursor, &next, 10);
+                if (next == cursor) break;
+                cursor = next;
+                for (const auto& field : kFields) {
+                    if (std::strlen(field.line) == name_len && std::memcmp(field.line, p, name_len) == 0 &&
+                        std::strlen(field.key) == key_len && std::memcmp(field.key, key, key_len) == 0) {
+                        out.*field.member = value;
+                        any = true;
+                    }
+                }
+            }
+        }
+        if (!eol) break;
+        p = eol + 1;
+    }
+    return any;
+}
+
+NetProtoCollector::NetProtoCollector(const std::string& proc_root)
+    : snmp_reader_(proc_root + "/net/snmp"),
+      netstat_reader_(proc_root + "/net/netstat"),
+      sockstat_reader_(proc_root + "/net/sockstat"),
+      sockstat6_reader_(proc_root + "/net/sockstat6"),
+      tcp_retransmit_percent_(-1),
+      has_previous_(false) {
+    for (int i = 0; i < kNetProtoCounterCount; ++i) {
+        values_[i] = 0;
+        previous_[i] = 0;
+        present_[i] = false;
+        rates_[i] = -1;
+    }
+}
+
+// Walk "Prefix: names..." / "Prefix: values..." line pairs; the n-th pair
+// reuses the n-th column index as long as its header text is unchanged
+void NetProtoCollector::parse_pairs(const ProcFileReader& reader, std::vector<HeaderIndex>& index) {
+    const char* p = reader.data();
+    const char* end = p + reader.size();
+    size_t pair = 0;
+    while (p < end) {
+        const char* header_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!header_end) break;
+        const char* values = header_end + 1;
+        const char* values_end = static_cast<const char*>(std::memchr(values, '\n', end - values));
+        if (!values_end) values_end = end;
+
+        size_t header_len = header_end - p;
+        if (pair >= index.size()) index.emplace_back();
+        HeaderIndex& columns = index[pair++];
+        if (columns.header.size() != header_len || std::memcmp(columns.header.data(), p, header_len) != 0) {
+            columns.header.assign(p, header_len);
+            columns.slots.clear();
+            const char* colon = static_cast<const char*>(std::memchr(p, ':', header_len));
+            const char* cursor = colon ? colon + 1 : header_end;
+            size_t prefix_len = colon ? colon - p : 0;
+            while (cursor < header_end) {
+                while (cursor < header_end && *cursor == ' ') ++cursor;
+                const char* name = cursor;
+                while (cursor < header_end && *cursor != ' ') ++cursor;
+                if (cursor > name) {
+                    columns.slots.push_back(net_proto_slot(p, prefix_len, name, cursor - name));
+                }
+            }
+        }
+
+        const char* colon = static_cast<const char*>(std::memchr(values, ':', values_end - values));
+        char* cursor = const_cast<char*>(colon ? colon + 1 : values_end);
+        for (size_t i = 0; i < columns.slots.size() && cursor < values_end; ++i) {
+            unsigned long long value = std::strtoull(cursor, &cursor, 10);
+            int slot = columns.slots[i];
+            if (slot >= 0) {
+                values_[slot] = value;
+                present_[slot] = true;
+            }
+        }
+        p = values_end + 1;
+    }
+    index.resize(pair);
+}
+
+bool NetProtoCollector::collect() {
+    for (int i = 0; i < kNetProtoCounterCount; ++i) {
+        previous_[i] = values_[i];
+        present_[i] = false;
+    }
+
+    bool ok = false;
+    if (snmp_reader_.read()) {
+        parse_pairs(snmp_reader_, snmp_index_);
+        ok = true;
+    }
+    if (netstat_reader_.read()) {
+        parse_pairs(netstat_reader_, netstat_index_);
+        ok = true;
+    }
+    sockstat_ = SockStat();
+    if (sockstat_reader_.read()) {
+        ok |= parse_sockstat(sockstat_reader_.data(), sockstat_);
+    }
+    if (sockstat6_reader_.read()) {
+        parse_sockstat(sockstat6_reader_.data(), sockstat_);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = has_previous_ ? std::chrono::duration<double>(now - last_time_).count() : 0.0;
+    for (int i = 0; i < kNetProtoCounterCount; ++i) {
+        if (!has_previous_ || !present_[i] || counter_is_gauge((NetProtoCounter)i)) {
+            rates_[i] = -1;
+        } else {
+            rates_[i] = counter_rate(previous_[i], values_[i], seconds);
+        }
+    }
+    tcp_retransmit_percent_ = -1;
+    if (has_previous_ && present_[kTcpOutSegs] && present_[kTcpRetransSegs] &&
+        values_[kTcpOutSegs] >= previous_[kTcpOutSegs] && values_[kTcpRetransSegs] >= previous_[kTcpRetransSegs]) {
+        unsigned long long out_segs = values_[kTcpOutSegs] - previous_[kTcpOutSegs];
+        unsigned long long retrans = values_[kTcpRetransSegs] - previous_[kTcpRetransSegs];
+        tcp_retransmit_percent_ = out_segs > 0 ? 100.0 * retrans / out_segs : 0.0;
+    }
+
+    last_time_ = now;
+    has_previous_ = true;
+    return true;
+}
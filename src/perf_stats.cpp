@@ -0,0 +1,233 @@
+#include "perf_stats.h"
+#include "cpufreq_stats.h"
+#include "proc_reader.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+struct PerfEventSpec {
+    uint32_t type;
+    uint64_t config;
+};
+
+static const PerfEventSpec kPerfEventSpecs[kPerfEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+static int perf_event_open(struct perf_event_attr* attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+    return (int)syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+PerfCollector::PerfCollector(bool system_wide, const std::vector<std::string>& cgroups,
+                             const std::string& cgroup_root, const std::string& sys_root)
+    : mode_("unavailable"), has_collected_(false) {
+    std::vector<int> cpus = parse_cpu_list(read_sysfs_string(sys_root + "/devices/system/cpu/online"));
+    if (cpus.empty()) {
+        error_ = "cannot read online CPU list";
+        return;
+    }
+
+    // One target per scope; cgroup targets count only tasks inside the cgroup
+    std::vector<int> cgroup_fds;
+    if (system_wide) {
+        PerfTargetStats target;
+        target.name = "system";
+        targets_.push_back(target);
+        cgroup_fds.push_back(-1);
+    }
+    for (const auto& path : cgroups) {
+        PerfTargetStats target;
+        target.name = path;
+        targets_.push_back(target);
+        int fd = open((cgroup_root + "/" + path).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        cgroup_fds.push_back(fd >= 0 ? fd : -2);
+    }
+
+    static const std::vector<PerfEvent> kHardwareEvents = {
+        kPerfCycles, kPerfInstructions, kPerfCacheMisses, kPerfBranchMisses, kPerfContextSwitches
+    };
+    // cpu-clock is left out: CPU-wide it only measures wall time, and some
+    // kernels read it (and its group siblings) as zero
+    static const std::vector<PerfEvent> kSoftwareEvents = {
+        kPerfContextSwitches, kPerfCpuMigrations, kPerfPageFaults
+    };
+    if (open_groups(kHardwareEvents, cpus, cgroup_fds)) {
+        mode_ = "hardware";
+    } else {
+        // No PMU exposed (VM, container, CI); software events are always implemented
+        close_groups();
+        if (open_groups(kSoftwareEvents, cpus, cgroup_fds)) {
+            mode_ = "software";
+        } else {
+            close_groups();
+            if (error_.empty()) error_ = "no perf event could be opened";
+        }
+    }
+    if (mode_ != "unavailable") {
+        error_.clear();
+    }
+
+    for (int fd : cgroup_fds) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+PerfCollector::~PerfCollector() {
+    close_groups();
+}
+
+bool PerfCollector::open_groups(const std::vector<PerfEvent>& events, const std::vector<int>& cpus,
+                                const std::vector<int>& cgroup_fds) {
+    events_ = events;
+    read_buffer_.assign(sizeof(uint64_t) * (3 + events.size()), 0);
+
+    for (size_t t = 0; t < targets_.size(); ++t) {
+        if (cgroup_fds[t] == -2) {
+            continue;  // cgroup directory missing
+        }
+        pid_t pid = cgroup_fds[t] >= 0 ? cgroup_fds[t] : -1;
+        unsigned long flags = PERF_FLAG_FD_CLOEXEC | (cgroup_fds[t] >= 0 ? PERF_FLAG_PID_CGROUP : 0);
+
+        size_t first_group = groups_.size();
+        bool target_ok = true;
+        for (int cpu : cpus) {
+            Group group;
+            group.target = t;
+            group.has_previous = false;
+            std::memset(group.previous, 0, sizeof(group.previous));
+            group.previous_enabled = 0;
+            group.previous_running = 0;
+
+            for (PerfEvent event : events) {
+                struct perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = kPerfEventSpecs[event].type;
+                attr.config = kPerfEventSpecs[event].config;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                int leader = group.fds.empty() ? -1 : group.fds[0];
+                int fd = perf_event_open(&attr, pid, cpu, leader, flags);
+                if (fd < 0) {
+                    if (error_.empty()) {
+                        error_ = std::string("perf_event_open: ") + std::strerror(errno);
+                        if (errno == EACCES || errno == EPERM) {
+                            error_ += " (needs CAP_PERFMON or kernel.perf_event_paranoid <= 0)";
+                        }
+                    }
+                    for (int open_fd : group.fds) close(open_fd);
+                    group.fds.clear();
+                    break;
+                }
+                group.fds.push_back(fd);
+            }
+            if (group.fds.empty()) {
+                target_ok = false;
+                break;
+            }
+            groups_.push_back(group);
+        }
+        if (!target_ok) {
+            for (size_t g = first_group; g < groups_.size(); ++g) {
+                for (size_t i = groups_[g].fds.size(); i-- > 0;) close(groups_[g].fds[i]);
+            }
+            groups_.resize(first_group);
+            if (groups_.empty()) {
+                // Nothing opened yet: let the caller try the next event set
+                return false;
+            }
+            continue;
+        }
+        targets_[t].available = true;
+    }
+    return !groups_.empty();
+}
+
+void PerfCollector::close_groups() {
+    for (auto& group : groups_) {
+        // Members first, then the leader
+        for (size_t i = group.fds.size(); i-- > 0;) {
+            close(group.fds[i]);
+        }
+    }
+    groups_.clear();
+    for (auto& target : targets_) {
+        target.available = false;
+    }
+}
+
+bool PerfCollector::collect() {
+    if (groups_.empty()) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = has_collected_ ? std::chrono::duration<double>(now - last_collect_).count() : 0;
+
+    for (auto& target : targets_) {
+        std::memset(target.deltas, 0, sizeof(target.deltas));
+        target.running_ratio = 1;
+    }
+
+    // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+    uint64_t* data = reinterpret_cast<uint64_t*>(read_buffer_.data());
+    for (auto& group : groups_) {
+        ssize_t n = read(group.fds[0], read_buffer_.data(), read_buffer_.size());
+        if (n < (ssize_t)(3 * sizeof(uint64_t)) || data[0] != events_.size()) {
+            continue;
+        }
+        uint64_t enabled = data[1];
+        uint64_t running = data[2];
+        PerfTargetStats& target = targets_[group.target];
+
+        // Scale this interval by its own enabled/running times: scaling the running
+        // totals would let an earlier multiplexed period distort every later delta
+        if (group.has_previous) {
+            uint64_t enabled_delta = enabled - group.previous_enabled;
+            uint64_t running_delta = running - group.previous_running;
+            if (enabled_delta > 0 && (double)running_delta / enabled_delta < target.running_ratio) {
+                target.running_ratio = (double)running_delta / enabled_delta;
+            }
+            // Not scheduled on the PMU at all (or, for a cgroup, no task ran): no estimate
+            if (running_delta > 0) {
+                double scale = (double)enabled_delta / running_delta;
+                for (size_t i = 0; i < events_.size(); ++i) {
+                    target.deltas[events_[i]] += (data[3 + i] - group.previous[events_[i]]) * scale;
+                }
+            }
+        }
+        for (size_t i = 0; i < events_.size(); ++i) {
+            group.previous[events_[i]] = data[3 + i];
+        }
+        group.previous_enabled = enabled;
+        group.previous_running = running;
+        group.has_previous = true;
+    }
+
+    for (auto& target : targets_) {
+        const double* d = target.deltas;
+        bool hardware = mode_ == "hardware";
+        bool have_rate = has_collected_ && elapsed > 0 && target.available;
+        target.ipc = have_rate && hardware && d[kPerfCycles] > 0 ? d[kPerfInstructions] / d[kPerfCycles] : -1;
+        target.cache_misses_per_kinstr = have_rate && hardware && d[kPerfInstructions] > 0
+            ? d[kPerfCacheMisses] * 1000.0 / d[kPerfInstructions] : -1;
+        target.branch_misses_per_kinstr = have_rate && hardware && d[kPerfInstructions] > 0
+            ? d[kPerfBranchMisses] * 1000.0 / d[kPerfInstructions] : -1;
+        target.context_switches_per_sec = have_rate ? d[kPerfContextSwitches] / elapsed : -1;
+        target.cpu_migrations_per_sec = have_rate && !hardware ? d[kPerfCpuMigrations] / elapsed : -1;
+        target.page_faults_per_sec = have_rate && !hardware ? d[kPerfPageFaults] / elapsed : -1;
+    }
+
+    last_collect_ = now;
+    has_collected_ = true;
+    return true;
+}
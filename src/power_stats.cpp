@@ -0,0 +1,223 @@
+#include "power_stats.h"
+#include "proc_reader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+// Numeric suffix of a "<prefix><N>_input" hwmon file, -1 if name does not match
+static int hwmon_channel(const std::string& name, const char* prefix) {
+    size_t len = std::strlen(prefix);
+    if (name.compare(0, len, prefix) != 0 || name.size() <= len + 6 ||
+        name.compare(name.size() - 6, 6, "_input") != 0) {
+        return -1;
+    }
+    std::string digits = name.substr(len, name.size() - len - 6);
+    if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos) {
+        return -1;
+    }
+    return std::atoi(digits.c_str());
+}
+
+long long energy_delta_uj(long long previous, long long current, long long max_range_uj) {
+    if (current >= previous) {
+        return current - previous;
+    }
+    // Counter wrapped: it runs from previous up to max_range_uj, then from 0 to current
+    return max_range_uj > 0 ? current + (max_range_uj - previous) : 0;
+}
+
+PowerCollector::PowerCollector(const std::string& sys_root)
+    : has_collected_(false) {
+    discover(sys_root);
+}
+
+PowerCollector::~PowerCollector() {
+    for (int& fd : energy_fds_) close_fd(fd);
+    for (auto& files : supply_files_) {
+        close_fd(files.status_fd);
+        close_fd(files.online_fd);
+        close_fd(files.capacity_fd);
+        close_fd(files.power_fd);
+        close_fd(files.voltage_fd);
+        close_fd(files.current_fd);
+    }
+    for (auto& files : sensor_files_) {
+        close_fd(files.power_fd);
+        close_fd(files.voltage_fd);
+        close_fd(files.current_fd);
+    }
+}
+
+void PowerCollector::discover(const std::string& sys_root) {
+    // powercap zones (intel-rapl:0, intel-rapl:0:0, ...); control-type dirs have no energy_uj
+    std::string powercap_dir = sys_root + "/class/powercap";
+    for (const auto& zone : list_entries(powercap_dir)) {
+        std::string base = powercap_dir + "/" + zone;
+        std::string max_range = read_sysfs_string(base + "/max_energy_range_uj");
+        if (max_range.empty()) continue;
+
+        PowerDomain domain;
+        domain.zone = zone;
+        domain.name = read_sysfs_string(base + "/name");
+        domain.max_energy_range_uj = std::atoll(max_range.c_str());
+        domains_.push_back(domain);
+        // energy_uj is root-only on kernels with the PLATYPUS mitigation; keep the domain listed
+        energy_fds_.push_back(open_attribute(base + "/energy_uj"));
+    }
+
+    std::string supply_dir = sys_root + "/class/power_supply";
+    for (const auto& name : list_entries(supply_dir)) {
+        std::string base = supply_dir + "/" + name;
+        PowerSupply supply;
+        supply.name = name;
+        supply.type = read_sysfs_string(base + "/type");
+        SupplyFiles files;
+        files.status_fd = open_attribute(base + "/status");
+        files.online_fd = open_attribute(base + "/online");
+        files.capacity_fd = open_attribute(base + "/capacity");
+        files.power_fd = open_attribute(base + "/power_now");
+        if (files.power_fd < 0) {
+            files.voltage_fd = open_attribute(base + "/voltage_now");
+            files.current_fd = open_attribute(base + "/current_now");
+        }
+        supplies_.push_back(supply);
+        supply_files_.push_back(files);
+    }
+
+    std::string hwmon_dir = sys_root + "/class/hwmon";
+    for (const auto& hwmon : list_numbered_entries(hwmon_dir, "hwmon")) {
+        std::string base = hwmon_dir + "/" + hwmon;
+        std::string chip = read_sysfs_string(base + "/name");
+        if (chip.empty()) chip = hwmon;
+
+        std::vector<std::string> entries = list_entries(base);
+        std::vector<int> power_channels;
+        for (const auto& entry : entries) {
+            int channel = hwmon_channel(entry, "power");
+            if (channel < 0) continue;
+            int fd = open_attribute(base + "/" + entry);
+            if (fd < 0) continue;
+
+            PowerSensor sensor;
+            sensor.chip = chip;
+            sensor.label = read_sysfs_string(base + "/power" + std::to_string(channel) + "_label");
+            if (sensor.label.empty()) sensor.label = "power" + std::to_string(channel);
+            SensorFiles files;
+            files.power_fd = fd;
+            sensors_.push_back(sensor);
+            sensor_files_.push_back(files);
+            power_channels.push_back(channel);
+        }
+
+        // INA3221-style: bus voltage in<N>_input paired with curr<N>_input, no power<N>_input
+        for (const auto& entry : entries) {
+            int channel = hwmon_channel(entry, "curr");
+            if (channel < 0) continue;
+            if (std::find(power_channels.begin(), power_channels.end(), channel) != power_channels.end()) continue;
+            std::string n = std::to_string(channel);
+            int voltage_fd = open_attribute(base + "/in" + n + "_input");
+            if (voltage_fd < 0) continue;
+            int current_fd = open_attribute(base + "/" + entry);
+            if (current_fd < 0) {
+                close(voltage_fd);
+                continue;
+            }
+
+            PowerSensor sensor;
+            sensor.chip = chip;
+            sensor.label = read_sysfs_string(base + "/in" + n + "_label");
+            if (sensor.label.empty()) sensor.label = read_sysfs_string(base + "/curr" + n + "_label");
+            if (sensor.label.empty()) sensor.label = "channel" + n;
+            SensorFiles files;
+            files.voltage_fd = voltage_fd;
+            files.current_fd = current_fd;
+            sensors_.push_back(sensor);
+            sensor_files_.push_back(files);
+        }
+    }
+}
+
+bool PowerCollector::collect() {
+    return collect(std::chrono::steady_clock::now());
+}
+
+bool PowerCollector::collect(std::chrono::steady_clock::time_point now) {
+    double elapsed = has_collected_ ? std::chrono::duration<double>(now - last_collect_).count() : 0;
+    bool any = false;
+
+    for (size_t i = 0; i < domains_.size(); ++i) {
+        PowerDomain& domain = domains_[i];
+        long long energy = 0;
+        if (energy_fds_[i] < 0 || !read_fd_long_long(energy_fds_[i], energy)) {
+            domain.ok = false;
+            domain.watts = -1;
+            continue;
+        }
+        if (domain.ok && elapsed > 0) {
+            domain.watts = energy_delta_uj(domain.energy_uj, energy, domain.max_energy_range_uj) / elapsed / 1e6;
+        } else {
+            domain.watts = -1;
+        }
+        domain.energy_uj = energy;
+        domain.ok = true;
+        any = true;
+    }
+
+    for (size_t i = 0; i < supplies_.size(); ++i) {
+        PowerSupply& supply = supplies_[i];
+        const SupplyFiles& files = supply_files_[i];
+        long long value = 0;
+        if (files.status_fd >= 0) {
+            char buf[32];
+            ssize_t n = pread(files.status_fd, buf, sizeof(buf) - 1, 0);
+            while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' ')) --n;
+            supply.status.assign(buf, n > 0 ? n : 0);
+        }
+        if (files.online_fd >= 0 && read_fd_long_long(files.online_fd, value)) supply.online = (int)value;
+        if (files.capacity_fd >= 0 && read_fd_long_long(files.capacity_fd, value)) supply.capacity_percent = (int)value;
+
+        supply.watts = -1;
+        if (files.power_fd >= 0 && read_fd_long_long(files.power_fd, value)) {
+            supply.watts = std::fabs((double)value) / 1e6;
+        } else if (files.voltage_fd >= 0 && files.current_fd >= 0) {
+            long long microvolts = 0, microamps = 0;
+            if (read_fd_long_long(files.voltage_fd, microvolts) && read_fd_long_long(files.current_fd, microamps)) {
+                // current_now is negative while discharging on some drivers
+                supply.watts = std::fabs((double)microvolts * microamps) / 1e12;
+            }
+        }
+        any |= supply.watts >= 0;
+    }
+
+    for (size_t i = 0; i < sensors_.size(); ++i) {
+        PowerSensor& sensor = sensors_[i];
+        const SensorFiles& files = sensor_files_[i];
+        long long value = 0;
+        if (files.power_fd >= 0) {
+            sensor.ok = read_fd_long_long(files.power_fd, value);
+            sensor.watts = value / 1e6;
+        } else {
+            long long millivolts = 0, milliamps = 0;
+            sensor.ok = read_fd_long_long(files.voltage_fd, millivolts) && read_fd_long_long(files.current_fd, milliamps);
+            sensor.watts = (double)millivolts * milliamps / 1e6;
+        }
+        any |= sensor.ok;
+    }
+
+    last_collect_ = now;
+    has_collected_ = true;
+    return any;
+}
+
+double PowerCollector::package_watts() const {
+    double total = 0;
+    bool any = false;
+    for (const auto& domain : domains_) {
+        if (domain.watts < 0 || domain.name.compare(0, 7, "package") != 0) continue;
+        total += domain.watts;
+        any = true;
+    }
+    return any ? total : -1;
+}
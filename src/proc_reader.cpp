@@ -0,0 +1,204 @@
+#include "proc_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+ProcFileReader::ProcFileReader(const std::string& path)
+    : path_(path), fd_(-1), error_(0), buffer_(4096), size_(0) {
+    fd_ = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) error_ = errno;
+    buffer_[0] = '\0';
+}
+
+ProcFileReader::~ProcFileReader() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool ProcFileReader::read() {
+    if (fd_ < 0) {
+        // The file may appear later (e.g. module loaded after startup)
+        fd_ = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            error_ = errno;
+            return false;
+        }
+    }
+
+    if (!pread_all(fd_, buffer_, size_)) {
+        error_ = errno;
+        buffer_[0] = '\0';
+        return false;
+    }
+    error_ = 0;
+    return true;
+}
+
+bool pread_all(int fd, std::vector<char>& buffer, size_t& size) {
+    if (buffer.size() < 64) {
+        buffer.resize(64);
+    }
+    size = 0;
+    while (true) {
+        if (buffer.size() - size < 2) {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t n = pread(fd, buffer.data() + size, buffer.size() - size - 1, (off_t)size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            size = 0;
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        size += (size_t)n;
+    }
+    buffer[size] = '\0';
+    return true;
+}
+
+bool read_fd_long_long(int fd, long long& out) {
+    char buf[32];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+        return false;
+    }
+    buf[n] = '\0';
+    char* end = nullptr;
+    long long value = std::strtoll(buf, &end, 10);
+    if (end == buf) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+std::string read_sysfs_string(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    if (file.is_open()) {
+        std::getline(file, value);
+    }
+    while (!value.empty() && (value.back() == '\n' || value.back() == ' ')) {
+        value.pop_back();
+    }
+    return value;
+}
+
+std::vector<std::string> list_numbered_entries(const std::string& dir, const std::string& prefix) {
+    std::vector<std::pair<long, std::string>> numbered;
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return std::vector<std::string>();
+    }
+    while (struct dirent* entry = readdir(d)) {
+        const char* name = entry->d_name;
+        if (std::strncmp(name, prefix.c_str(), prefix.size()) != 0) continue;
+        const char* digits = name + prefix.size();
+        if (*digits < '0' || *digits > '9') continue;
+        char* end = nullptr;
+        long number = std::strtol(digits, &end, 10);
+        if (*end != '\0') continue;
+        numbered.emplace_back(number, name);
+    }
+    closedir(d);
+
+    std::sort(numbered.begin(), numbered.end());
+    std::vector<std::string> names;
+    names.reserve(numbered.size());
+    for (auto& entry : numbered) {
+        names.push_back(entry.second);
+    }
+    return names;
+}
+
+std::vector<std::string> list_entries(const std::string& dir) {
+    std::vector<std::string> names;
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return names;
+    }
+    while (struct dirent* entry = readdir(d)) {
+        if (entry->d_name[0] == '.') continue;
+        names.push_back(entry->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+int open_attribute(const std::string& path) {
+    return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+void close_fd(int& fd) {
+    if (fd >= 0) close(fd);
+    fd = -1;
+}
+
+// Trailing slashes removed so "<root>/stat" never has "//"; "/" becomes ""
+static std::string normalize_root(const char* path) {
+    std::string root(path);
+    while (!root.empty() && root.back() == '/') {
+        root.pop_back();
+    }
+    return root;
+}
+
+struct HostPaths {
+    std::string proc_root;
+    std::string sys_root;
+    std::string rootfs;
+    bool proc_from_env;
+    bool sys_from_env;
+    bool rootfs_from_env;
+};
+
+static HostPaths& host_paths() {
+    static HostPaths paths = [] {
+        HostPaths p;
+        const char* env_proc = std::getenv("HOST_PROC");
+        const char* env_sys = std::getenv("HOST_SYS");
+        const char* env_root = std::getenv("HOST_ROOT");
+        p.proc_from_env = env_proc != nullptr && *env_proc != '\0';
+        p.sys_from_env = env_sys != nullptr && *env_sys != '\0';
+        p.rootfs_from_env = env_root != nullptr && *env_root != '\0';
+        p.proc_root = p.proc_from_env ? normalize_root(env_proc) : "/proc";
+        p.sys_root = p.sys_from_env ? normalize_root(env_sys) : "/sys";
+        p.rootfs = p.rootfs_from_env ? normalize_root(env_root) : "";
+        return p;
+    }();
+    return paths;
+}
+
+const std::string& host_proc_root() {
+    return host_paths().proc_root;
+}
+
+const std::string& host_sys_root() {
+    return host_paths().sys_root;
+}
+
+const std::string& host_rootfs() {
+    return host_paths().rootfs;
+}
+
+void set_host_paths(const std::string& proc_root, const std::string& sys_root, const std::string& rootfs) {
+    HostPaths& paths = host_paths();
+    if (!proc_root.empty() && !paths.proc_from_env) {
+        paths.proc_root = normalize_root(proc_root.c_str());
+    }
+    if (!sys_root.empty() && !paths.sys_from_env) {
+        paths.sys_root = normalize_root(sys_root.c_str());
+    }
+    if (!rootfs.empty() && !paths.rootfs_from_env) {
+        paths.rootfs = normalize_root(rootfs.c_str());
+    }
+}
@@ -0,0 +1,476 @@
+#include "process_stats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+// Minimum spacing between /proc scans for a cmdline binding that matched nothing
+static const std::chrono::seconds kCmdlineRescanInterval(5);
+
+bool parse_proc_pid_stat(const char* text, ProcPidStat& out) {
+    const char* open_paren = std::strchr(text, '(');
+    const char* close_paren = std::strrchr(text, ')');
+    if (open_paren == nullptr || close_paren == nullptr || close_paren < open_paren) {
+        return false;
+    }
+    out.comm.assign(open_paren + 1, close_paren - open_paren - 1);
+
+    // Field 3 (state) follows ") "; count the remaining space-separated fields
+    const char* p = close_paren + 1;
+    int field = 2;
+    while (*p) {
+        while (*p == ' ') ++p;
+        if (!*p || *p == '\n') break;
+        ++field;
+        char* end = nullptr;
+        switch (field) {
+        case 3:
+            out.state = *p;
+            break;
+        case 14:
+            out.utime_ticks = std::strtoull(p, &end, 10);
+            break;
+        case 15:
+            out.stime_ticks = std::strtoull(p, &end, 10);
+            break;
+        case 20:
+            out.num_threads = std::strtol(p, &end, 10);
+            break;
+        case 22:
+            out.starttime_ticks = std::strtoull(p, &end, 10);
+            break;
+        case 24:
+            out.rss_pages = std::strtoll(p, &end, 10);
+            return true;
+        }
+        while (*p && *p != ' ' && *p != '\n') ++p;
+    }
+    return false;
+}
+
+// Parse "rchar: N\nwchar: N\n...read_bytes: N\nwrite_bytes: N\n"
+static void parse_proc_pid_io(const char* text, long long& read_bytes, long long& write_bytes) {
+    const char* p = text;
+    while (p && *p) {
+        if (std::strncmp(p, "read_bytes:", 11) == 0) {
+            read_bytes = std::atoll(p + 11);
+        } else if (std::strncmp(p, "write_bytes:", 12) == 0) {
+            write_bytes = std::atoll(p + 12);
+        }
+        p = std::strchr(p, '\n');
+        if (p) ++p;
+    }
+}
+
+// Whitespace- or newline-separated PID list, as in cgroup.procs
+static std::vector<int> parse_pid_list(const char* text) {
+    std::vector<int> pids;
+    const char* p = text;
+    while (*p) {
+        char* end = nullptr;
+        long pid = std::strtol(p, &end, 10);
+        if (end == p) {
+            ++p;
+            continue;
+        }
+        if (pid > 0) pids.push_back((int)pid);
+        p = end;
+    }
+    std::sort(pids.begin(), pids.end());
+    return pids;
+}
+
+// /proc/[pid]/cmdline with argument separators turned into spaces
+static std::string read_cmdline(const std::string& path) {
+    std::string cmdline;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return cmdline;
+    }
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        cmdline.append(buf, n);
+    }
+    close(fd);
+    std::replace(cmdline.begin(), cmdline.end(), '\0', ' ');
+    return cmdline;
+}
+
+InstanceProcessCollector::InstanceProcessCollector(const std::vector<InstanceBinding>& bindings,
+                                                   const std::string& proc_root,
+                                                   const std::string& cgroup_root)
+    : proc_root_(proc_root), cgroup_root_(cgroup_root),
+      ticks_per_second_(sysconf(_SC_CLK_TCK)), page_size_(sysconf(_SC_PAGESIZE)) {
+    instances_.resize(bindings.size());
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        Instance& instance = instances_[i];
+        instance.binding = bindings[i];
+        instance.stats.id = bindings[i].id;
+        if (!bindings[i].pidfile.empty()) {
+            instance.stats.bound_by = "pidfile";
+        } else if (!bindings[i].cgroup.empty()) {
+            instance.stats.bound_by = "cgroup";
+            instance.cgroup_procs.reset(new ProcFileReader(cgroup_root_ + "/" + bindings[i].cgroup + "/cgroup.procs"));
+        } else {
+            instance.stats.bound_by = "cmdline";
+        }
+        index_[bindings[i].id] = i;
+    }
+}
+
+std::vector<int> InstanceProcessCollector::resolve_pids(Instance& instance) {
+    const InstanceBinding& binding = instance.binding;
+    instance.last_resolve = std::chrono::steady_clock::now();
+    instance.resolved = true;
+    std::vector<int> pids;
+
+    if (!binding.pidfile.empty()) {
+        int pid = std::atoi(read_sysfs_string(binding.pidfile).c_str());
+        if (pid > 0) pids.push_back(pid);
+    } else if (instance.cgroup_procs) {
+        if (instance.cgroup_procs->read()) {
+            pids = parse_pid_list(instance.cgroup_procs->data());
+        }
+    } else if (!binding.cmdline.empty()) {
+        DIR* dir = opendir(proc_root_.c_str());
+        if (dir == nullptr) {
+            return pids;
+        }
+        int self = getpid();
+        while (struct dirent* entry = readdir(dir)) {
+            int pid = std::atoi(entry->d_name);
+            if (pid <= 0 || pid == self) continue;
+            std::string cmdline = read_cmdline(proc_root_ + "/" + entry->d_name + "/cmdline");
+            if (cmdline.find(binding.cmdline) != std::string::npos) {
+                pids.push_back(pid);
+            }
+        }
+        closedir(dir);
+        std::sort(pids.begin(), pids.end());
+    }
+    return pids;
+}
+
+// Replace the tracked set with pids, keeping open files and history of survivors
+void InstanceProcessCollector::track(Instance& instance, const std::vector<int>& pids) {
+    std::vector<TrackedProcess> tracked;
+    tracked.reserve(pids.size());
+    for (int pid : pids) {
+        auto it = std::find_if(instance.processes.begin(), instance.processes.end(),
+                               [pid](const TrackedProcess& p) { return p.pid == pid; });
+        if (it != instance.processes.end()) {
+            tracked.push_back(std::move(*it));
+            continue;
+        }
+        std::string base = proc_root_ + "/" + std::to_string(pid);
+        TrackedProcess process;
+        process.pid = pid;
+        process.stat.reset(new ProcFileReader(base + "/stat"));
+        if (!process.stat->is_open()) continue;
+        process.statm.reset(new ProcFileReader(base + "/statm"));
+        process.io.reset(new ProcFileReader(base + "/io"));
+        tracked.push_back(std::move(process));
+    }
+    instance.processes.swap(tracked);
+}
+
+const InstanceProcessStats* InstanceProcessCollector::collect(const std::string& id) {
+    auto found = index_.find(id);
+    if (found == index_.end()) {
+        return nullptr;
+    }
+    Instance& instance = instances_[found->second];
+    auto now = std::chrono::steady_clock::now();
+
+    if (instance.cgroup_procs) {
+        // cgroup.procs is cheap and authoritative; re-track only if membership changed
+        std::vector<int> pids = resolve_pids(instance);
+        bool same = pids.size() == instance.processes.size();
+        for (size_t i = 0; same && i < pids.size(); ++i) {
+            same = pids[i] == instance.processes[i].pid;
+        }
+        if (!same) track(instance, pids);
+    } else if (!instance.resolved ||
+               (instance.processes.empty() &&
+                (instance.binding.cmdline.empty() || now - instance.last_resolve >= kCmdlineRescanInterval))) {
+        track(instance, resolve_pids(instance));
+    }
+
+    InstanceProcessStats& stats = instance.stats;
+    double elapsed = std::chrono::duration<double>(now - instance.last_sample).count();
+    unsigned long long delta_ticks = 0;
+    long long delta_read = 0;
+    long long delta_write = 0;
+    bool have_rate = false;
+    bool any_exited = false;
+
+    stats.pids.clear();
+    stats.num_threads = 0;
+    stats.cpu_time_ticks = 0;
+    stats.rss_bytes = 0;
+    stats.vm_bytes = 0;
+    stats.io_available = false;
+    stats.io_errno = 0;
+    stats.read_bytes = 0;
+    stats.write_bytes = 0;
+
+    for (auto& process : instance.processes) {
+        ProcPidStat pid_stat;
+        if (!process.stat->read() || !parse_proc_pid_stat(process.stat->data(), pid_stat)) {
+            process.pid = 0;
+            any_exited = true;
+            continue;
+        }
+        if (process.starttime_ticks == 0) {
+            process.starttime_ticks = pid_stat.starttime_ticks;
+        } else if (process.starttime_ticks != pid_stat.starttime_ticks) {
+            // PID was reused by an unrelated process
+            process.pid = 0;
+            any_exited = true;
+            continue;
+        }
+
+        unsigned long long cpu_ticks = pid_stat.utime_ticks + pid_stat.stime_ticks;
+        stats.pids.push_back(process.pid);
+        stats.num_threads += pid_stat.num_threads;
+        stats.cpu_time_ticks += cpu_ticks;
+
+        if (process.statm->read()) {
+            long long size_pages = 0, resident_pages = 0;
+            const char* p = process.statm->data();
+            char* end = nullptr;
+            size_pages = std::strtoll(p, &end, 10);
+            resident_pages = std::strtoll(end, nullptr, 10);
+            stats.vm_bytes += size_pages * page_size_;
+            stats.rss_bytes += resident_pages * page_size_;
+        }
+
+        long long read_bytes = 0, write_bytes = 0;
+        bool io_ok = process.io->read();
+        if (io_ok) {
+            parse_proc_pid_io(process.io->data(), read_bytes, write_bytes);
+            stats.io_available = true;
+            stats.read_bytes += read_bytes;
+            stats.write_bytes += write_bytes;
+        } else if (stats.io_errno == 0) {
+            stats.io_errno = process.io->error();
+        }
+
+        if (process.has_previous) {
+            delta_ticks += cpu_ticks - process.prev_cpu_ticks;
+            if (io_ok) {
+                delta_read += read_bytes - process.prev_read_bytes;
+                delta_write += write_bytes - process.prev_write_bytes;
+            }
+            have_rate = true;
+        }
+        process.has_previous = true;
+        process.prev_cpu_ticks = cpu_ticks;
+        process.prev_read_bytes = read_bytes;
+        process.prev_write_bytes = write_bytes;
+    }
+
+    if (any_exited) {
+        instance.processes.erase(std::remove_if(instance.processes.begin(), instance.processes.end(),
+                                                [](const TrackedProcess& p) { return p.pid == 0; }),
+                                 instance.processes.end());
+        // Pick up a restarted process on the next request rather than scanning now
+        if (!instance.cgroup_procs) instance.resolved = false;
+    }
+
+    if (have_rate && elapsed > 0) {
+        stats.cpu_percent = (double)delta_ticks / ticks_per_second_ / elapsed * 100.0;
+        stats.read_bytes_per_sec = stats.io_available ? delta_read / elapsed : -1;
+        stats.write_bytes_per_sec = stats.io_available ? delta_write / elapsed : -1;
+    } else {
+        stats.cpu_percent = -1;
+        stats.read_bytes_per_sec = -1;
+        stats.write_bytes_per_sec = -1;
+    }
+    instance.last_sample = now;
+    return &stats;
+}
+
+bool parse_process_sort_key(const std::string& name, ProcessSortKey& out) {
+    if (name.empty() || name == "cpu") {
+        out = ProcessSortKey::Cpu;
+        return true;
+    }
+    if (name == "memory" || name == "mem" || name == "rss") {
+        out = ProcessSortKey::Memory;
+        return true;
+    }
+    return false;
+}
+
+ProcessTableScanner::ProcessTableScanner(const std::string& proc_root)
+    : proc_root_(proc_root), generation_(0), open_fds_(0), fd_budget_(0),
+      ticks_per_second_(sysconf(_SC_CLK_TCK)), page_size_(sysconf(_SC_PAGESIZE)),
+      uptime_fd_(-1), last_new_(0), last_exited_(0), last_scan_us_(0) {
+    // Cache stat fds only up to the descriptor limit, leaving room for sockets
+    // and the other collectors; PIDs beyond the budget are opened per scan
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+        fd_budget_ = limit.rlim_cur > 512 ? (size_t)limit.rlim_cur - 256 : (size_t)limit.rlim_cur / 2;
+    } else {
+        fd_budget_ = 65536;
+    }
+    uptime_fd_ = open((proc_root_ + "/uptime").c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+ProcessTableScanner::~ProcessTableScanner() {
+    for (auto& entry : cache_) {
+        if (entry.second.stat_fd >= 0) close(entry.second.stat_fd);
+    }
+    if (uptime_fd_ >= 0) close(uptime_fd_);
+}
+
+double ProcessTableScanner::read_uptime_seconds() {
+    char buf[64];
+    ssize_t n = uptime_fd_ >= 0 ? pread(uptime_fd_, buf, sizeof(buf) - 1, 0) : -1;
+    if (n <= 0) {
+        return 0;
+    }
+    buf[n] = '\0';
+    return std::strtod(buf, nullptr);
+}
+
+bool ProcessTableScanner::read_stat(int pid, CachedProcess& cached, char* buf, size_t buf_size, size_t& len) {
+    int fd = cached.stat_fd;
+    if (fd < 0) {
+        std::string path = proc_root_ + "/" + std::to_string(pid) + "/stat";
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+    }
+    ssize_t n = pread(fd, buf, buf_size - 1, 0);
+    if (fd != cached.stat_fd) {
+        close(fd);
+    }
+    if (n <= 0) {
+        return false;
+    }
+    buf[n] = '\0';
+    len = (size_t)n;
+    return true;
+}
+
+std::vector<ProcessEntry> ProcessTableScanner::scan(size_t top_n, ProcessSortKey key) {
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = generation_ > 0 ? std::chrono::duration<double>(start - last_scan_).count() : 0;
+    double uptime = read_uptime_seconds();
+    generation_++;
+    last_new_ = 0;
+    last_exited_ = 0;
+
+    // Min-heap on the sort key: the front is the weakest of the current top N
+    auto better = [key](const ProcessEntry& a, const ProcessEntry& b) {
+        double score_a = key == ProcessSortKey::Cpu ? a.cpu_percent : (double)a.rss_bytes;
+        double score_b = key == ProcessSortKey::Cpu ? b.cpu_percent : (double)b.rss_bytes;
+        if (score_a != score_b) return score_a > score_b;
+        return a.pid < b.pid;
+    };
+    std::vector<ProcessEntry> heap;
+    heap.reserve(top_n + 1);
+
+    DIR* dir = opendir(proc_root_.c_str());
+    if (dir == nullptr) {
+        return heap;
+    }
+    char buf[1024];
+    ProcPidStat stat;
+    ProcessEntry candidate;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') continue;
+        int pid = std::atoi(entry->d_name);
+
+        auto it = cache_.find(pid);
+        if (it == cache_.end()) {
+            // New since the previous listing
+            CachedProcess cached;
+            std::string path = proc_root_ + "/" + entry->d_name + "/stat";
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            struct stat st;
+            if (fstat(fd, &st) == 0) cached.uid = st.st_uid;
+            if (open_fds_ < fd_budget_) {
+                cached.stat_fd = fd;
+                open_fds_++;
+            } else {
+                close(fd);
+            }
+            it = cache_.emplace(pid, cached).first;
+            last_new_++;
+        }
+        CachedProcess& cached = it->second;
+
+        size_t len = 0;
+        if (!read_stat(pid, cached, buf, sizeof(buf), len) || !parse_proc_pid_stat(buf, stat)) {
+            // Exited between readdir and read (or the PID was reused and our fd is stale);
+            // leave it unmarked so the sweep below drops it
+            continue;
+        }
+        cached.generation = generation_;
+        if (cached.starttime_ticks != stat.starttime_ticks) {
+            cached.starttime_ticks = stat.starttime_ticks;
+            cached.has_previous = false;
+        }
+
+        unsigned long long ticks = stat.utime_ticks + stat.stime_ticks;
+        double cpu_percent = 0;
+        if (cached.has_previous && elapsed > 0) {
+            cpu_percent = (double)(ticks - cached.last_ticks) / ticks_per_second_ / elapsed * 100.0;
+        } else {
+            // First sight of this PID: average over its lifetime, as top does for its first frame
+            double age = uptime - (double)stat.starttime_ticks / ticks_per_second_;
+            if (age > 0) cpu_percent = (double)ticks / ticks_per_second_ / age * 100.0;
+        }
+        cached.last_ticks = ticks;
+        cached.has_previous = true;
+
+        if (top_n == 0) continue;
+        candidate.pid = pid;
+        candidate.cpu_percent = cpu_percent;
+        candidate.rss_bytes = stat.rss_pages * page_size_;
+        if (heap.size() == top_n && !better(candidate, heap.front())) continue;
+
+        candidate.uid = cached.uid;
+        candidate.comm = stat.comm;
+        candidate.state = stat.state;
+        candidate.num_threads = stat.num_threads;
+        candidate.cpu_time_ticks = ticks;
+        if (heap.size() == top_n) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = candidate;
+        } else {
+            heap.push_back(candidate);
+        }
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+    closedir(dir);
+
+    // Drop PIDs that were not seen in this listing
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        if (it->second.generation != generation_) {
+            if (it->second.stat_fd >= 0) {
+                close(it->second.stat_fd);
+                open_fds_--;
+            }
+            it = cache_.erase(it);
+            last_exited_++;
+        } else {
+            ++it;
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), better);
+    last_scan_ = start;
+    last_scan_us_ = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return heap;
+}
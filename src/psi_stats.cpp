@@ -0,0 +1,233 @@
+#include "psi_stats.h"
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+static const char* const kPsiResources[] = {"cpu", "memory", "io"};
+
+// Parse "avg10=0.00 avg60=0.00 avg300=0.00 total=0" after the some/full keyword
+static void parse_psi_line(const char* p, PsiLine& line) {
+    const char* eol = std::strchr(p, '\n');
+    if (!eol) eol = p + std::strlen(p);
+    while (p < eol) {
+        const char* eq = static_cast<const char*>(std::memchr(p, '=', eol - p));
+        if (!eq) break;
+        const char* key = eq;
+        while (key > p && key[-1] != ' ') --key;
+        char* next = nullptr;
+        if (eq - key == 5 && std::strncmp(key, "avg10", 5) == 0) {
+            line.avg10 = std::strtod(eq + 1, &next);
+        } else if (eq - key == 5 && std::strncmp(key, "avg60", 5) == 0) {
+            line.avg60 = std::strtod(eq + 1, &next);
+        } else if (eq - key == 6 && std::strncmp(key, "avg300", 6) == 0) {
+            line.avg300 = std::strtod(eq + 1, &next);
+        } else if (eq - key == 5 && std::strncmp(key, "total", 5) == 0) {
+            line.total_us = std::strtoull(eq + 1, &next, 10);
+        }
+        p = next && next > eq ? next : eq + 1;
+    }
+}
+
+bool parse_psi(const char* text, PsiResource& res) {
+    res.available = false;
+    res.has_full = false;
+    const char* p = text;
+    while (p && *p) {
+        if (std::strncmp(p, "some ", 5) == 0) {
+            parse_psi_line(p + 5, res.some);
+            res.available = true;
+        } else if (std::strncmp(p, "full ", 5) == 0) {
+            parse_psi_line(p + 5, res.full);
+            res.has_full = true;
+        }
+        p = std::strchr(p, '\n');
+        if (p) ++p;
+    }
+    return res.available;
+}
+
+PsiCollector::PsiCollector(const std::vector<std::string>& cgroups,
+                           const std::string& proc_pressure_dir,
+                           const std::string& cgroup_root) {
+    for (const char* name : kPsiResources) {
+        PsiResource res;
+        res.name = name;
+        system_.push_back(res);
+        readers_.emplace_back(new ProcFileReader(proc_pressure_dir + "/" + name));
+    }
+    for (const auto& path : cgroups) {
+        PsiCgroup cg;
+        cg.path = path;
+        for (const char* name : kPsiResources) {
+            PsiResource res;
+            res.name = name;
+            cg.resources.push_back(res);
+            readers_.emplace_back(new ProcFileReader(cgroup_root + "/" + path + "/" + name + ".pressure"));
+        }
+        cgroups_.push_back(cg);
+    }
+}
+
+bool PsiCollector::collect() {
+    size_t reader = 0;
+    bool any = false;
+    for (auto& res : system_) {
+        ProcFileReader& r = *readers_[reader++];
+        any |= r.read() && parse_psi(r.data(), res);
+    }
+    for (auto& cg : cgroups_) {
+        for (auto& res : cg.resources) {
+            ProcFileReader& r = *readers_[reader++];
+            if (!r.read() || !parse_psi(r.data(), res)) {
+                res.available = false;
+            }
+        }
+    }
+    return any;
+}
+
+const PsiResource* PsiCollector::find(const std::string& name) const {
+    for (const auto& res : system_) {
+        if (res.name == name) return &res;
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Trigger watcher
+
+struct PsiTrigger {
+    std::string spec;
+    int fd;
+};
+
+static std::mutex g_watcher_mutex;
+static std::thread g_watcher_thread;
+static std::vector<PsiTrigger> g_triggers;
+static int g_watcher_wakeup_fd = -1;
+static std::atomic<unsigned long long> g_trigger_events(0);
+
+// Open a pressure file and register "<some|full> <stall_us> <window_us>" on it
+static int arm_psi_trigger(const std::string& spec, const std::string& proc_pressure_dir,
+                           const std::string& cgroup_root) {
+    std::string resource_spec = spec;
+    std::string cgroup;
+    size_t colon = resource_spec.find(':');
+    if (colon != std::string::npos) {
+        cgroup = resource_spec.substr(0, colon);
+        resource_spec = resource_spec.substr(colon + 1);
+    }
+
+    size_t space = resource_spec.find(' ');
+    if (space == std::string::npos) {
+        return -1;
+    }
+    std::string resource = resource_spec.substr(0, space);
+    std::string threshold = resource_spec.substr(space + 1);
+
+    std::string path = cgroup.empty()
+        ? proc_pressure_dir + "/" + resource
+        : cgroup_root + "/" + cgroup + "/" + resource + ".pressure";
+
+    int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "PSI trigger: cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    // The kernel expects the trailing NUL as part of the write
+    if (write(fd, threshold.c_str(), threshold.size() + 1) < 0) {
+        std::cerr << "PSI trigger: invalid trigger \"" << spec << "\": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void watcher_loop(std::function<void(const std::string&)> on_event) {
+    std::vector<struct pollfd> pfds;
+    pfds.push_back({g_watcher_wakeup_fd, POLLIN, 0});
+    for (const auto& trigger : g_triggers) {
+        pfds.push_back({trigger.fd, POLLPRI, 0});
+    }
+
+    while (true) {
+        int n = poll(pfds.data(), pfds.size(), -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfds[0].revents & POLLIN) {
+            break;  // Stop requested
+        }
+        for (size_t i = 1; i < pfds.size(); ++i) {
+            if (pfds[i].revents & POLLERR) {
+                // Monitored resource (e.g. cgroup) went away
+                pfds[i].fd = -1;
+            } else if (pfds[i].revents & POLLPRI) {
+                g_trigger_events++;
+                on_event(g_triggers[i - 1].spec);
+            }
+        }
+    }
+}
+
+int start_psi_trigger_watcher(const std::vector<std::string>& triggers,
+                              std::function<void(const std::string& trigger)> on_event,
+                              const std::string& proc_pressure_dir,
+                              const std::string& cgroup_root) {
+    std::lock_guard<std::mutex> lock(g_watcher_mutex);
+    if (g_watcher_thread.joinable() || triggers.empty()) {
+        return 0;
+    }
+
+    for (const auto& spec : triggers) {
+        int fd = arm_psi_trigger(spec, proc_pressure_dir, cgroup_root);
+        if (fd >= 0) {
+            g_triggers.push_back({spec, fd});
+        }
+    }
+    if (g_triggers.empty()) {
+        return 0;
+    }
+
+    g_watcher_wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (g_watcher_wakeup_fd < 0) {
+        for (const auto& trigger : g_triggers) close(trigger.fd);
+        g_triggers.clear();
+        return 0;
+    }
+    g_watcher_thread = std::thread(watcher_loop, on_event);
+    return (int)g_triggers.size();
+}
+
+void stop_psi_trigger_watcher() {
+    std::lock_guard<std::mutex> lock(g_watcher_mutex);
+    if (!g_watcher_thread.joinable()) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(g_watcher_wakeup_fd, &one, sizeof(one)) < 0) {
+        // Nothing else to do; join below would hang, so detach instead
+        g_watcher_thread.detach();
+        return;
+    }
+    g_watcher_thread.join();
+    close(g_watcher_wakeup_fd);
+    g_watcher_wakeup_fd = -1;
+    for (const auto& trigger : g_triggers) {
+        close(trigger.fd);
+    }
+    g_triggers.clear();
+}
+
+unsigned long long get_psi_trigger_event_count() {
+    return g_trigger_events.load();
+}
@@ -0,0 +1,215 @@
+#include "sched_stats.h"
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+// Parse "user nice system idle iowait irq softirq steal ..." after the cpu label
+static const char* parse_cpu_times(const char* p, CpuTimes& out) {
+    long long v[8] = {0};
+    char* cursor = const_cast<char*>(p);
+    for (int i = 0; i < 8; ++i) {
+        v[i] = std::strtoll(cursor, &cursor, 10);
+    }
+    // guest/guest_nice are already included in user/nice
+    out.total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+    out.idle = v[3] + v[4];
+    return cursor;
+}
+
+static bool starts_with(const char* p, const char* end, const char* prefix, size_t len) {
+    return (size_t)(end - p) >= len && std::memcmp(p, prefix, len) == 0;
+}
+
+bool parse_proc_stat(const char* text, ProcStat& out) {
+    bool have_cpu = false;
+    for (auto& times : out.per_cpu) times = CpuTimes();
+
+    const char* p = text;
+    const char* text_end = p + std::strlen(p);
+    while (p < text_end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', text_end - p));
+        if (!eol) eol = text_end;
+
+        if (p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+            if (p[3] == ' ') {
+                parse_cpu_times(p + 3, out.cpu);
+                have_cpu = true;
+            } else if (p[3] >= '0' && p[3] <= '9') {
+                char* cursor = nullptr;
+                long cpu = std::strtol(p + 3, &cursor, 10);
+                if (cpu >= 0 && cpu < 65536) {
+                    if ((size_t)cpu >= out.per_cpu.size()) out.per_cpu.resize(cpu + 1);
+                    parse_cpu_times(cursor, out.per_cpu[cpu]);
+                }
+            }
+        } else if (starts_with(p, eol, "ctxt ", 5)) {
+            out.context_switches = std::strtoull(p + 5, nullptr, 10);
+        } else if (starts_with(p, eol, "intr ", 5)) {
+            // Followed by one count per IRQ line; only the total is kept
+            out.interrupts = std::strtoull(p + 5, nullptr, 10);
+        } else if (starts_with(p, eol, "softirq ", 8)) {
+            out.softirqs = std::strtoull(p + 8, nullptr, 10);
+        } else if (starts_with(p, eol, "processes ", 10)) {
+            out.forks = std::strtoull(p + 10, nullptr, 10);
+        } else if (starts_with(p, eol, "procs_running ", 14)) {
+            out.procs_running = std::atoi(p + 14);
+        } else if (starts_with(p, eol, "procs_blocked ", 14)) {
+            out.procs_blocked = std::atoi(p + 14);
+        }
+        p = eol + 1;
+    }
+    return have_cpu;
+}
+
+bool parse_loadavg(const char* text, LoadAvg& out) {
+    char* cursor = nullptr;
+    out.load1 = std::strtod(text, &cursor);
+    if (cursor == text) {
+        out.load1 = -1;
+        return false;
+    }
+    out.load5 = std::strtod(cursor, &cursor);
+    out.load15 = std::strtod(cursor, &cursor);
+    out.runnable = (int)std::strtol(cursor, &cursor, 10);
+    if (*cursor == '/') {
+        out.total = (int)std::strtol(cursor + 1, &cursor, 10);
+    }
+    return true;
+}
+
+bool parse_softirqs(const char* text, std::vector<int>& cpus, std::vector<SoftirqRow>& rows) {
+    const char* p = text;
+    const char* eol = std::strchr(p, '\n');
+    if (!eol) return false;
+
+    // Header: "                    CPU0       CPU1 ..."
+    cpus.clear();
+    while ((p = std::strstr(p, "CPU")) != nullptr && p < eol) {
+        char* cursor = nullptr;
+        cpus.push_back((int)std::strtol(p + 3, &cursor, 10));
+        p = cursor;
+    }
+
+    // Rows keep their order across reads, so the row at the same index is reused
+    size_t row = 0;
+    p = eol + 1;
+    while (*p) {
+        eol = std::strchr(p, '\n');
+        const char* line_end = eol ? eol : p + std::strlen(p);
+        while (p < line_end && *p == ' ') ++p;
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', line_end - p));
+        if (colon) {
+            if (row >= rows.size()) rows.emplace_back();
+            SoftirqRow& r = rows[row++];
+            if (r.name.size() != (size_t)(colon - p) || r.name.compare(0, colon - p, p, colon - p) != 0) {
+                r.name.assign(p, colon - p);
+            }
+            r.per_cpu.resize(cpus.size());
+            r.total = 0;
+            char* cursor = const_cast<char*>(colon + 1);
+            for (size_t i = 0; i < cpus.size(); ++i) {
+                r.per_cpu[i] = std::strtoull(cursor, &cursor, 10);
+                r.total += r.per_cpu[i];
+            }
+        }
+        if (!eol) break;
+        p = eol + 1;
+    }
+    rows.resize(row);
+    return !cpus.empty() && row > 0;
+}
+
+double cpu_usage_between(const CpuTimes& prev, const CpuTimes& cur) {
+    if (prev.total == 0) {
+        return -1.0; // No previous measurement
+    }
+
+    long long total_diff = cur.total - prev.total;
+    long long idle_diff = cur.idle - prev.idle;
+
+    if (total_diff <= 0) return 0.0;
+
+    return 100.0 * (1.0 - (double)idle_diff / total_diff);
+}
+
+static double counter_rate(unsigned long long prev, unsigned long long cur, double seconds) {
+    if (seconds <= 0) return -1;
+    return cur >= prev ? (double)(cur - prev) / seconds : 0.0;
+}
+
+SchedCollector::SchedCollector(const std::string& proc_root)
+    : stat_reader_(proc_root + "/stat"),
+      loadavg_reader_(proc_root + "/loadavg"),
+      softirqs_reader_(proc_root + "/softirqs"),
+      cpu_usage_percent_(-1),
+      context_switches_per_sec_(-1),
+      interrupts_per_sec_(-1),
+      forks_per_sec_(-1),
+      has_collected_(false) {
+}
+
+bool SchedCollector::collect() {
+    // Swap so the previous reading is kept and its per-CPU storage is reused
+    std::swap(previous_stat_, stat_);
+    if (!stat_reader_.read() || !parse_proc_stat(stat_reader_.data(), stat_)) {
+        std::swap(previous_stat_, stat_);
+        return false;
+    }
+    const ProcStat& previous = previous_stat_;
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = has_collected_ ? std::chrono::duration<double>(now - last_collect_).count() : 0;
+
+    cpu_usage_percent_ = has_collected_ ? cpu_usage_between(previous.cpu, stat_.cpu) : -1;
+    per_cpu_usage_percent_.resize(stat_.per_cpu.size());
+    for (size_t i = 0; i < stat_.per_cpu.size(); ++i) {
+        bool known = has_collected_ && i < previous.per_cpu.size() && stat_.per_cpu[i].total > 0;
+        per_cpu_usage_percent_[i] = known ? cpu_usage_between(previous.per_cpu[i], stat_.per_cpu[i]) : -1;
+    }
+    context_switches_per_sec_ = counter_rate(previous.context_switches, stat_.context_switches, elapsed);
+    interrupts_per_sec_ = counter_rate(previous.interrupts, stat_.interrupts, elapsed);
+    forks_per_sec_ = counter_rate(previous.forks, stat_.forks, elapsed);
+
+    if (!loadavg_reader_.read() || !parse_loadavg(loadavg_reader_.data(), loadavg_)) {
+        loadavg_ = LoadAvg();
+    }
+
+    // Flatten the previous softirq counters so rates need no per-row copies
+    previous_softirq_.clear();
+    for (const auto& row : softirqs_) {
+        previous_softirq_.push_back(row.total);
+        previous_softirq_.insert(previous_softirq_.end(), row.per_cpu.begin(), row.per_cpu.end());
+    }
+    size_t previous_columns = softirq_cpus_.size();
+    size_t previous_rows = softirqs_.size();
+    if (softirqs_reader_.read() && parse_softirqs(softirqs_reader_.data(), softirq_cpus_, softirqs_)) {
+        // A changed layout (CPU hotplug) makes the previous counters incomparable
+        bool comparable = has_collected_ && previous_columns == softirq_cpus_.size() &&
+                          previous_rows == softirqs_.size();
+        size_t offset = 0;
+        for (auto& row : softirqs_) {
+            row.per_cpu_per_sec.assign(row.per_cpu.size(), -1);
+            row.per_sec = -1;
+            if (comparable) {
+                row.per_sec = counter_rate(previous_softirq_[offset], row.total, elapsed);
+                for (size_t i = 0; i < row.per_cpu.size(); ++i) {
+                    row.per_cpu_per_sec[i] = counter_rate(previous_softirq_[offset + 1 + i], row.per_cpu[i], elapsed);
+                }
+            }
+            offset += 1 + row.per_cpu.size();
+        }
+    } else {
+        softirq_cpus_.clear();
+        softirqs_.clear();
+    }
+
+    last_collect_ = now;
+    has_collected_ = true;
+    return true;
+}
+
+const SoftirqRow* SchedCollector::find_softirq(const char* name) const {
+    for (const auto& row : softirqs_) {
+        if (row.name == name) return &row;
+    }
+    return nullptr;
+}
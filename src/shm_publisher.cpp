@@ -0,0 +1,99 @@
+#include "shm_publisher.h"
+#include "metrics_shm.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <sys/file.h>
+
+static MetricsShmSegment* g_segment = nullptr;
+static std::string g_segment_name;
+static int g_segment_fd = -1;
+
+bool open_metrics_shm(const std::string& name) {
+    if (g_segment != nullptr) {
+        return true;
+    }
+
+    // World-readable, owner-writable: consumers can only map it read-only
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Shared memory: shm_open(" << name << ") failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // The lock lives as long as the fd, so a second daemon cannot become a writer
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        std::cerr << "Shared memory: " << name << " is already published by another process" << std::endl;
+        close(fd);
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(MetricsShmSegment)) != 0) {
+        std::cerr << "Shared memory: ftruncate failed: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void* addr = mmap(nullptr, sizeof(MetricsShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Shared memory: mmap failed: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // Start from a clean, even sequence so readers never see a torn header
+    std::memset(addr, 0, sizeof(MetricsShmSegment));
+    MetricsShmSegment* segment = new (addr) MetricsShmSegment();
+    segment->magic = METRICS_SHM_MAGIC;
+    segment->version = METRICS_SHM_VERSION;
+    segment->data_size = sizeof(MetricsShmData);
+    segment->writer_pid = (uint32_t)getpid();
+    segment->sequence.store(0, std::memory_order_release);
+
+    g_segment = segment;
+    g_segment_name = name;
+    g_segment_fd = fd;
+    return true;
+}
+
+void publish_metrics_shm(const StatusSample& sample) {
+    if (g_segment == nullptr) {
+        return;
+    }
+
+    MetricsShmData data;
+    std::memset(&data, 0, sizeof(data));
+    data.sample_sequence = sample.sequence;
+    data.timestamp_ms = sample.timestamp_ms;
+    data.cpu_usage_percent = sample.cpu_usage_percent;
+    data.ram_total_bytes = sample.ram_total_bytes;
+    data.ram_available_bytes = sample.ram_available_bytes;
+    data.ram_free_bytes = sample.ram_free_bytes;
+    data.uptime_seconds = sample.uptime_seconds;
+    data.sample_interval_ms = sample.sample_interval_ms;
+    int zones = sample.thermal_zone_count;
+    if (zones > METRICS_SHM_MAX_THERMAL_ZONES) zones = METRICS_SHM_MAX_THERMAL_ZONES;
+    data.thermal_zone_count = zones;
+    for (int i = 0; i < zones; ++i) {
+        data.thermal_millicelsius[i] = sample.thermal_millicelsius[i];
+    }
+
+    // Seqlock write: odd sequence while the payload is being replaced
+    uint32_t seq = g_segment->sequence.load(std::memory_order_relaxed);
+    g_segment->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&g_segment->data, &data, sizeof(data));
+    g_segment->sequence.store(seq + 2, std::memory_order_release);
+}
+
+void close_metrics_shm() {
+    if (g_segment == nullptr) {
+        return;
+    }
+    munmap(g_segment, sizeof(MetricsShmSegment));
+    shm_unlink(g_segment_name.c_str());
+    close(g_segment_fd);
+    g_segment = nullptr;
+    g_segment_fd = -1;
+}
@@ -0,0 +1,234 @@
+#include "statsd_exporter.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netdb.h>
+#include <unistd.h>
+
+static std::mutex g_exporter_mutex;
+static std::condition_variable g_exporter_cv;
+static std::thread g_exporter_thread;
+static bool g_exporter_stop = false;
+
+// Append one "name:value|g" line, starting a new datagram when it would not fit
+static void append_gauge(std::vector<std::string>& packets, const std::string& prefix,
+                         const char* name, double value, size_t max_packet_bytes) {
+    std::ostringstream line;
+    if (!prefix.empty()) line << prefix << ".";
+    // StatsD does not accept exponent notation, so always print fixed-point
+    int precision = (value == (double)(long long)value) ? 0 : 2;
+    line << name << ":" << std::fixed << std::setprecision(precision) << value << "|g";
+    std::string text = line.str();
+
+    if (packets.empty() || packets.back().size() + 1 + text.size() > max_packet_bytes) {
+        packets.emplace_back();
+        packets.back().reserve(max_packet_bytes);
+    } else {
+        packets.back() += '\n';
+    }
+    packets.back() += text;
+}
+
+std::vector<std::string> build_statsd_packets(const StatusSample& sample,
+                                              const std::string& prefix,
+                                              size_t max_packet_bytes) {
+    std::vector<std::string> packets;
+
+    if (sample.cpu_usage_percent >= 0) {
+        append_gauge(packets, prefix, "cpu.usage_percent", sample.cpu_usage_percent, max_packet_bytes);
+    }
+    if (sample.load1 >= 0) {
+        append_gauge(packets, prefix, "load.1m", sample.load1, max_packet_bytes);
+        append_gauge(packets, prefix, "load.5m", sample.load5, max_packet_bytes);
+        append_gauge(packets, prefix, "load.15m", sample.load15, max_packet_bytes);
+    }
+    append_gauge(packets, prefix, "sched.procs_running", sample.procs_running, max_packet_bytes);
+    append_gauge(packets, prefix, "sched.procs_blocked", sample.procs_blocked, max_packet_bytes);
+    if (sample.context_switches_per_sec >= 0) {
+        append_gauge(packets, prefix, "sched.context_switches_per_sec", sample.context_switches_per_sec, max_packet_bytes);
+        append_gauge(packets, prefix, "sched.interrupts_per_sec", sample.interrupts_per_sec, max_packet_bytes);
+    }
+    if (sample.net_rx_softirqs_per_sec >= 0) {
+        append_gauge(packets, prefix, "sched.net_rx_softirqs_per_sec", sample.net_rx_softirqs_per_sec, max_packet_bytes);
+    }
+    append_gauge(packets, prefix, "ram.total_bytes", (double)sample.ram_total_bytes, max_packet_bytes);
+    append_gauge(packets, prefix, "ram.used_bytes",
+                 (double)(sample.ram_total_bytes - sample.ram_available_bytes), max_packet_bytes);
+    append_gauge(packets, prefix, "ram.free_bytes", (double)sample.ram_free_bytes, max_packet_bytes);
+    append_gauge(packets, prefix, "ram.available_bytes", (double)sample.ram_available_bytes, max_packet_bytes);
+    append_gauge(packets, prefix, "swap.total_bytes", (double)sample.swap_total_bytes, max_packet_bytes);
+    append_gauge(packets, prefix, "swap.used_bytes",
+                 (double)(sample.swap_total_bytes - sample.swap_free_bytes), max_packet_bytes);
+    if (sample.swap_in_pages_per_sec >= 0) {
+        append_gauge(packets, prefix, "swap.in_pages_per_sec", sample.swap_in_pages_per_sec, max_packet_bytes);
+        append_gauge(packets, prefix, "swap.out_pages_per_sec", sample.swap_out_pages_per_sec, max_packet_bytes);
+    }
+    if (sample.major_faults_per_sec >= 0) {
+        append_gauge(packets, prefix, "vm.major_faults_per_sec", sample.major_faults_per_sec, max_packet_bytes);
+    }
+    if (sample.direct_reclaim_pages_per_sec >= 0) {
+        append_gauge(packets, prefix, "vm.direct_reclaim_pages_per_sec", sample.direct_reclaim_pages_per_sec, max_packet_bytes);
+    }
+    if (sample.oom_kills >= 0) {
+        append_gauge(packets, prefix, "vm.oom_kills", (double)sample.oom_kills, max_packet_bytes);
+    }
+    append_gauge(packets, prefix, "uptime_seconds", (double)sample.uptime_seconds, max_packet_bytes);
+    if (sample.sample_interval_ms > 0) {
+        append_gauge(packets, prefix, "sampler.interval_ms", sample.sample_interval_ms, max_packet_bytes);
+        append_gauge(packets, prefix, "sampler.rate_hz", 1000.0 / sample.sample_interval_ms, max_packet_bytes);
+    }
+    if (sample.psi_cpu_some_avg10 >= 0) {
+        append_gauge(packets, prefix, "psi.cpu.some_avg10", sample.psi_cpu_some_avg10, max_packet_bytes);
+    }
+    if (sample.psi_memory_some_avg10 >= 0) {
+        append_gauge(packets, prefix, "psi.memory.some_avg10", sample.psi_memory_some_avg10, max_packet_bytes);
+        append_gauge(packets, prefix, "psi.memory.full_avg10", sample.psi_memory_full_avg10, max_packet_bytes);
+    }
+    if (sample.psi_io_some_avg10 >= 0) {
+        append_gauge(packets, prefix, "psi.io.some_avg10", sample.psi_io_some_avg10, max_packet_bytes);
+        append_gauge(packets, prefix, "psi.io.full_avg10", sample.psi_io_full_avg10, max_packet_bytes);
+    }
+    for (int i = 0; i < sample.thermal_zone_count; ++i) {
+        std::string name = "thermal.zone" + std::to_string(i) + ".celsius";
+        append_gauge(packets, prefix, name.c_str(), sample.thermal_millicelsius[i] / 1000.0, max_packet_bytes);
+    }
+    append_gauge(packets, prefix, "thermal.throttling", sample.thermal_throttling ? 1 : 0, max_packet_bytes);
+    for (int i = 0; i < sample.power_reading_count; ++i) {
+        // Labels come from sysfs; keep them out of the StatsD "name:value|type" syntax
+        std::string name = std::string("power.") + sample.power_names[i] + ".watts";
+        for (char& c : name) {
+            if (c == ':' || c == '|' || c == '@' || c == ' ' || c == '\n') c = '_';
+        }
+        append_gauge(packets, prefix, name.c_str(), sample.power_watts[i], max_packet_bytes);
+    }
+
+    return packets;
+}
+
+// Create a non-blocking UDP socket connected to the StatsD target
+static int open_statsd_socket(const StatsdConfig& config) {
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    struct addrinfo* result = nullptr;
+    std::string port = std::to_string(config.port);
+    int ret = getaddrinfo(config.host.c_str(), port.c_str(), &hints, &result);
+    if (ret != 0) {
+        std::cerr << "StatsD: cannot resolve " << config.host << ": " << gai_strerror(ret) << std::endl;
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+
+    if (fd < 0) {
+        std::cerr << "StatsD: cannot open socket to " << config.host << ":" << config.port << std::endl;
+    }
+    return fd;
+}
+
+// Send all packets without blocking; datagrams that cannot be queued are dropped
+static void send_packets(int fd, const std::vector<std::string>& packets) {
+#if defined(__linux__)
+    std::vector<struct iovec> iov(packets.size());
+    std::vector<struct mmsghdr> msgs(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) {
+        iov[i].iov_base = const_cast<char*>(packets[i].data());
+        iov[i].iov_len = packets[i].size();
+        std::memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sent = 0;
+    while (sent < msgs.size()) {
+        int n = sendmmsg(fd, msgs.data() + sent, msgs.size() - sent, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // EAGAIN: socket buffer full, ECONNREFUSED: no agent listening right now
+            break;
+        }
+        sent += n;
+    }
+#else
+    for (const auto& packet : packets) {
+        if (send(fd, packet.data(), packet.size(), MSG_DONTWAIT) < 0 && errno != EINTR) {
+            break;
+        }
+    }
+#endif
+}
+
+static void exporter_loop(StatsdConfig config) {
+    int fd = open_statsd_socket(config);
+    uint64_t last_sequence = 0;
+
+    std::unique_lock<std::mutex> lock(g_exporter_mutex);
+    while (!g_exporter_stop) {
+        lock.unlock();
+
+        if (fd < 0) {
+            // Target may not be resolvable yet (e.g. DNS at boot), retry every period
+            fd = open_statsd_socket(config);
+        }
+
+        // One fresh sample per push is all the exporter needs from the adaptive sampler
+        note_status_sample_demand(config.interval_ms);
+        StatusSample sample;
+        if (fd >= 0 && get_latest_status_sample(sample) && sample.sequence != last_sequence) {
+            last_sequence = sample.sequence;
+            send_packets(fd, build_statsd_packets(sample, config.prefix, config.max_packet_bytes));
+        }
+
+        lock.lock();
+        g_exporter_cv.wait_for(lock, std::chrono::milliseconds(config.interval_ms),
+                               [] { return g_exporter_stop; });
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+void start_statsd_exporter(const StatsdConfig& config) {
+    if (!config.enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_exporter_mutex);
+    if (g_exporter_thread.joinable()) {
+        return;
+    }
+    g_exporter_stop = false;
+    g_exporter_thread = std::thread(exporter_loop, config);
+}
+
+void stop_statsd_exporter() {
+    {
+        std::lock_guard<std::mutex> lock(g_exporter_mutex);
+        if (!g_exporter_thread.joinable()) {
+            return;
+        }
+        g_exporter_stop = true;
+    }
+    g_exporter_cv.notify_all();
+    g_exporter_thread.join();
+}
@@ -0,0 +1,330 @@
+#include "status_sampler.h"
+#include "psi_stats.h"
+#include "thermal_stats.h"
+#include "power_stats.h"
+#include "mem_stats.h"
+#include "sched_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+static std::mutex g_sample_mutex;          // Guards g_latest_sample only
+static StatusSample g_latest_sample;
+
+static std::mutex g_sampler_mutex;         // Guards thread lifecycle
+static std::condition_variable g_sampler_cv;
+static std::thread g_sampler_thread;
+static bool g_sampler_stop = false;
+static bool g_sample_requested = false;
+static std::vector<StatusSampleListener> g_listeners;  // Fixed once the thread runs
+
+// Client demand, guarded by g_sampler_mutex
+static std::chrono::steady_clock::time_point g_demand_until;
+static int g_demand_interval_ms = 0;       // Never below g_fast_interval_ms
+static int g_fast_interval_ms = 1000;      // config.interval_ms of the running sampler
+static int g_current_interval_ms = 0;      // Period the sampler is currently sleeping for
+static bool g_demand_raised = false;       // Demand asks for a shorter period than the current one
+static int g_demand_hold_ms = 30000;
+
+// Copy zone temperatures and the throttling flag into the sample
+static void read_thermal(ThermalCollector& thermal, StatusSample& sample) {
+    thermal.collect();
+    int count = 0;
+    for (const auto& zone : thermal.zones()) {
+        if (count >= STATUS_SAMPLE_MAX_THERMAL_ZONES) break;
+        sample.thermal_millicelsius[count++] = zone.ok ? (int)zone.temp_millicelsius : 0;
+    }
+    sample.thermal_zone_count = count;
+    sample.thermal_throttling = thermal.throttling();
+}
+
+// Copy power readings with a rate into the sample as "<source>.<name>" / watts
+static void read_power(PowerCollector& power, StatusSample& sample) {
+    power.collect();
+    int count = 0;
+    auto add = [&](const std::string& name, double watts) {
+        if (watts < 0 || count >= STATUS_SAMPLE_MAX_POWER_READINGS) return;
+        std::snprintf(sample.power_names[count], STATUS_SAMPLE_POWER_NAME_LEN, "%s", name.c_str());
+        sample.power_watts[count++] = watts;
+    };
+    for (const auto& domain : power.domains()) {
+        // Subzones (intel-rapl:0:1) are named after their package: rapl.package-0.dram
+        std::string name = domain.name;
+        size_t last_colon = domain.zone.rfind(':');
+        if (last_colon != std::string::npos && domain.zone.find(':') != last_colon) {
+            std::string parent_zone = domain.zone.substr(0, last_colon);
+            for (const auto& parent : power.domains()) {
+                if (parent.zone == parent_zone) name = parent.name + "." + name;
+            }
+        }
+        add("rapl." + name, domain.watts);
+    }
+    for (const auto& sensor : power.sensors()) {
+        if (sensor.ok) add("hwmon." + sensor.chip + "." + sensor.label, sensor.watts);
+    }
+    for (const auto& supply : power.supplies()) {
+        add("supply." + supply.name, supply.watts);
+    }
+    sample.power_reading_count = count;
+}
+
+// Copy CPU usage, load and scheduler activity from one pass over /proc/stat
+static void read_sched(SchedCollector& sched, StatusSample& sample) {
+    if (!sched.collect()) {
+        return;
+    }
+    sample.cpu_usage_percent = sched.cpu_usage_percent();
+    sample.load1 = sched.loadavg().load1;
+    sample.load5 = sched.loadavg().load5;
+    sample.load15 = sched.loadavg().load15;
+    sample.procs_running = sched.stat().procs_running;
+    sample.procs_blocked = sched.stat().procs_blocked;
+    sample.context_switches_per_sec = sched.context_switches_per_sec();
+    sample.interrupts_per_sec = sched.interrupts_per_sec();
+    const SoftirqRow* net_rx = sched.find_softirq("NET_RX");
+    sample.net_rx_softirqs_per_sec = net_rx != nullptr ? net_rx->per_sec : -1;
+}
+
+// Copy RAM, swap and reclaim figures from /proc/meminfo and /proc/vmstat into the sample
+static void read_memory(MemoryCollector& memory, StatusSample& sample) {
+    if (!memory.collect()) {
+        return;
+    }
+    const MeminfoValues& mem = memory.meminfo();
+    sample.ram_total_bytes = mem.bytes[kMemTotal];
+    sample.ram_free_bytes = mem.bytes[kMemFree];
+    sample.ram_available_bytes = mem.present[kMemAvailable] ? mem.bytes[kMemAvailable]
+        : mem.bytes[kMemFree] + mem.bytes[kMemBuffers] + mem.bytes[kMemCached];
+    sample.swap_total_bytes = mem.bytes[kMemSwapTotal];
+    sample.swap_free_bytes = mem.bytes[kMemSwapFree];
+    sample.swap_in_pages_per_sec = memory.vmstat_rate(kVmPswpin);
+    sample.swap_out_pages_per_sec = memory.vmstat_rate(kVmPswpout);
+    sample.major_faults_per_sec = memory.vmstat_rate(kVmPgmajfault);
+    sample.direct_reclaim_pages_per_sec = memory.vmstat_rate(kVmPgstealDirect);
+    const VmstatValues& vm = memory.vmstat();
+    sample.oom_kills = vm.present[kVmOomKill] ? (long long)vm.counts[kVmOomKill] : -1;
+}
+
+static long long read_uptime_seconds() {
+    std::ifstream uptime_file(host_proc_root() + "/uptime");
+    double uptime_seconds = 0;
+    if (uptime_file.is_open()) {
+        uptime_file >> uptime_seconds;
+    }
+    return (long long)uptime_seconds;
+}
+
+// True when sample differs enough from the previous one that the next should come soon
+static bool is_volatile(const SamplerConfig& config, const StatusSample& prev, const StatusSample& cur) {
+    if (prev.sequence == 0) {
+        return true;
+    }
+    if (cur.cpu_usage_percent >= 0 && prev.cpu_usage_percent >= 0 &&
+        std::fabs(cur.cpu_usage_percent - prev.cpu_usage_percent) >= config.cpu_change_percent) {
+        return true;
+    }
+    if (cur.ram_total_bytes > 0 &&
+        std::llabs(cur.ram_available_bytes - prev.ram_available_bytes) * 100.0 / cur.ram_total_bytes >= config.memory_change_percent) {
+        return true;
+    }
+    if (cur.thermal_throttling != prev.thermal_throttling || cur.oom_kills > prev.oom_kills) {
+        return true;
+    }
+    int zones = std::min(cur.thermal_zone_count, prev.thermal_zone_count);
+    for (int i = 0; i < zones; ++i) {
+        if (std::abs(cur.thermal_millicelsius[i] - prev.thermal_millicelsius[i]) >= config.temperature_change_c * 1000) {
+            return true;
+        }
+    }
+    // Ongoing stalls keep the fast rate for as long as they last, not only while they change
+    return cur.psi_cpu_some_avg10 >= config.psi_some_percent ||
+           cur.psi_memory_some_avg10 >= config.psi_some_percent ||
+           cur.psi_io_some_avg10 >= config.psi_some_percent;
+}
+
+// The sampler keeps its own collector instances rather than sharing the status
+// registry's: cpu_usage_percent, vmstat rates and RAPL watts are deltas since
+// the owner's previous collect(), and the sampler's change detection needs them
+// over its own adaptive period. Each pass is one pread per kept-open file
+static void sampler_loop(SamplerConfig config) {
+    SchedCollector sched;
+    PsiCollector psi;
+    ThermalCollector thermal;
+    PowerCollector power;
+    MemoryCollector memory;
+    uint64_t sequence = 0;
+    StatusSample previous;
+    int interval_ms = config.interval_ms;
+    bool triggered = false;
+
+    std::unique_lock<std::mutex> lock(g_sampler_mutex);
+    while (!g_sampler_stop) {
+        lock.unlock();
+
+        // Collect outside of any lock so readers are never held up by /proc I/O
+        auto sampled_at = std::chrono::steady_clock::now();
+        StatusSample sample;
+        read_sched(sched, sample);
+        read_memory(memory, sample);
+        sample.uptime_seconds = read_uptime_seconds();
+        read_thermal(thermal, sample);
+        read_power(power, sample);
+        if (psi.collect()) {
+            const PsiResource* cpu_psi = psi.find("cpu");
+            const PsiResource* memory_psi = psi.find("memory");
+            const PsiResource* io_psi = psi.find("io");
+            if (cpu_psi && cpu_psi->available) sample.psi_cpu_some_avg10 = cpu_psi->some.avg10;
+            if (memory_psi && memory_psi->available) {
+                sample.psi_memory_some_avg10 = memory_psi->some.avg10;
+                sample.psi_memory_full_avg10 = memory_psi->full.avg10;
+            }
+            if (io_psi && io_psi->available) {
+                sample.psi_io_some_avg10 = io_psi->some.avg10;
+                sample.psi_io_full_avg10 = io_psi->full.avg10;
+            }
+        }
+        sample.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        sample.sequence = ++sequence;
+
+        // Next period: fastest on a trigger or a change, otherwise back off towards the
+        // idle period, but never slower than an active client asked for
+        int demand_ms = -1;
+        {
+            std::lock_guard<std::mutex> demand_lock(g_sampler_mutex);
+            if (std::chrono::steady_clock::now() < g_demand_until) {
+                demand_ms = g_demand_interval_ms;
+            }
+            g_demand_raised = false;
+        }
+        if (config.idle_interval_ms <= config.interval_ms) {
+            interval_ms = config.interval_ms;
+            sample.sampling_reason = "fixed";
+        } else if (triggered) {
+            interval_ms = config.interval_ms;
+            sample.sampling_reason = "trigger";
+        } else if (is_volatile(config, previous, sample)) {
+            interval_ms = config.interval_ms;
+            sample.sampling_reason = "change";
+        } else {
+            interval_ms = std::min(config.idle_interval_ms, interval_ms * 2);
+            sample.sampling_reason = "stable";
+            if (demand_ms >= 0 && demand_ms < interval_ms) {
+                interval_ms = demand_ms;
+                sample.sampling_reason = "demand";
+            }
+        }
+        sample.sample_interval_ms = interval_ms;
+        previous = sample;
+
+        {
+            std::lock_guard<std::mutex> sample_lock(g_sample_mutex);
+            g_latest_sample = sample;
+        }
+        for (const auto& listener : g_listeners) {
+            listener(sample);
+        }
+
+        lock.lock();
+        g_current_interval_ms = interval_ms;
+        auto deadline = sampled_at + std::chrono::milliseconds(interval_ms);
+        while (!g_sampler_stop && !g_sample_requested) {
+            // New demand only pulls the next sample forward to its period; it does not take one now
+            if (g_demand_raised) {
+                g_demand_raised = false;
+                if (g_demand_interval_ms < g_current_interval_ms) {
+                    g_current_interval_ms = g_demand_interval_ms;
+                    deadline = std::min(deadline, sampled_at + std::chrono::milliseconds(g_current_interval_ms));
+                }
+            }
+            if (!g_sampler_cv.wait_until(lock, deadline,
+                                         [] { return g_sampler_stop || g_sample_requested || g_demand_raised; })) {
+                break;
+            }
+        }
+        triggered = g_sample_requested;
+        g_sample_requested = false;
+    }
+}
+
+void add_status_sample_listener(StatusSampleListener listener) {
+    std::lock_guard<std::mutex> lock(g_sampler_mutex);
+    if (!g_sampler_thread.joinable()) {
+        g_listeners.push_back(listener);
+    }
+}
+
+void start_status_sampler(const SamplerConfig& config) {
+    std::lock_guard<std::mutex> lock(g_sampler_mutex);
+    if (g_sampler_thread.joinable()) {
+        return;
+    }
+    SamplerConfig effective = config;
+    if (effective.interval_ms <= 0) {
+        effective.interval_ms = 1000;
+    }
+    g_sampler_stop = false;
+    g_current_interval_ms = effective.interval_ms;
+    g_fast_interval_ms = effective.interval_ms;
+    g_demand_hold_ms = effective.demand_hold_ms;
+    g_sampler_thread = std::thread(sampler_loop, effective);
+}
+
+void stop_status_sampler() {
+    {
+        std::lock_guard<std::mutex> lock(g_sampler_mutex);
+        if (!g_sampler_thread.joinable()) {
+            return;
+        }
+        g_sampler_stop = true;
+    }
+    g_sampler_cv.notify_all();
+    g_sampler_thread.join();
+}
+
+void request_status_sample() {
+    {
+        std::lock_guard<std::mutex> lock(g_sampler_mutex);
+        g_sample_requested = true;
+    }
+    g_sampler_cv.notify_all();
+}
+
+void note_status_sample_demand(int interval_ms) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(g_sampler_mutex);
+        auto now = std::chrono::steady_clock::now();
+        // 0 (and anything faster than the sampler can go) means the configured fastest period
+        int period_ms = std::max(interval_ms, g_fast_interval_ms);
+        // Overlapping clients: the most demanding one wins until all have gone quiet
+        if (now >= g_demand_until || period_ms < g_demand_interval_ms) {
+            g_demand_interval_ms = period_ms;
+        }
+        g_demand_until = now + std::chrono::milliseconds(g_demand_hold_ms);
+        // Wake only if this shortens the sleep; a client at the current rate costs nothing
+        if (g_sampler_thread.joinable() && period_ms < g_current_interval_ms) {
+            g_demand_raised = true;
+            wake = true;
+        }
+    }
+    if (wake) {
+        g_sampler_cv.notify_all();
+    }
+}
+
+bool get_latest_status_sample(StatusSample& out) {
+    std::lock_guard<std::mutex> lock(g_sample_mutex);
+    if (g_latest_sample.sequence == 0) {
+        return false;
+    }
+    out = g_latest_sample;
+    return true;
+}
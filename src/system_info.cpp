@@ -1,6 +1,7 @@
 #include "system_info.h"
 #include "device_config.h"
 #include "json_utils.h"
+#include "topology.h"
 #include <hwinfo/hwinfo.h>
 #include <hwinfo/cpu.h>
 #include <hwinfo/gpu.h>
@@ -13,15 +14,15 @@
 #include <vector>
 
 std::string get_system_info_json() {
-    // Load device config if not already loaded
-    // Only reload if needed (after POST, config is already reloaded)
-    load_device_config();
+    // One snapshot for device, endpoint port and instances (loaded on first use,
+    // replaced by POST and the config watcher without affecting this reference)
+    std::shared_ptr<const DeviceState> state = get_device_state();
     
     std::ostringstream json;
     json << "{\n";
     
     // Device Information
-    DeviceInfo device = get_device_info();
+    const DeviceInfo& device = state->info;
     json << "  \"device\": {\n";
     json << "    \"version\": \"" << escape_json(device.version) << "\",\n";
     json << "    \"serial_number\": \"" << escape_json(device.serial_number) << "\",\n";
@@ -48,14 +49,15 @@ std::string get_system_info_json() {
     json << "  },\n";
     
     // Endpoint Port
-    json << "  \"endpoint_port\": \"" << escape_json(get_endpoint_port()) << "\",\n";
+    json << "  \"endpoint_port\": \"" << escape_json(device.endpoint_port.empty() ? "3546" : device.endpoint_port) << "\",\n";
     
     // Instances
-    std::vector<std::string> instances = get_device_instances();
+    const InstanceSet& instances = state->instances;
     json << "  \"instances\": [\n";
-    for (size_t i = 0; i < instances.size(); ++i) {
-        json << "    \"" << escape_json(instances[i]) << "\"";
-        if (i < instances.size() - 1) json << ",";
+    size_t written = 0;
+    for (const auto& instance : instances) {
+        json << "    \"" << escape_json(instance) << "\"";
+        if (++written < instances.size()) json << ",";
         json << "\n";
     }
     json << "  ],\n";
@@ -84,6 +86,58 @@ std::string get_system_info_json() {
     }
     json << "  ],\n";
     
+    // CPU topology: SMT siblings, clusters, cache sharing and NUMA nodes (read once at startup)
+    const CpuTopology& topology = get_cpu_topology();
+    auto write_list = [&json](const std::vector<int>& values) {
+        json << "[";
+        for (size_t i = 0; i < values.size(); ++i) {
+            json << (i > 0 ? ", " : "") << values[i];
+        }
+        json << "]";
+    };
+    json << "  \"topology\": {\n";
+    json << "    \"packages\": " << topology.packages << ",\n";
+    json << "    \"cores\": " << topology.cores << ",\n";
+    json << "    \"logical_cpus\": " << topology.cpus.size() << ",\n";
+    json << "    \"threads_per_core\": " << topology.threads_per_core << ",\n";
+    json << "    \"smt_active\": " << (topology.smt_active ? "true" : "false") << ",\n";
+    json << "    \"cpus\": [\n";
+    for (size_t i = 0; i < topology.cpus.size(); ++i) {
+        const auto& cpu = topology.cpus[i];
+        json << "      {\"cpu\": " << cpu.cpu << ", \"package\": " << cpu.package << ", \"die\": " << cpu.die;
+        json << ", \"cluster\": " << cpu.cluster << ", \"core\": " << cpu.core << ", \"node\": " << cpu.node;
+        json << ", \"siblings\": ";
+        write_list(cpu.siblings);
+        json << ", \"caches\": ";
+        write_list(cpu.caches);
+        json << "}" << (i < topology.cpus.size() - 1 ? ",\n" : "\n");
+    }
+    json << "    ],\n";
+    json << "    \"caches\": [\n";
+    for (size_t i = 0; i < topology.caches.size(); ++i) {
+        const auto& cache = topology.caches[i];
+        json << "      {\"id\": " << i << ", \"level\": " << cache.level;
+        json << ", \"type\": \"" << escape_json(cache.type) << "\"";
+        json << ", \"size_bytes\": " << cache.size_bytes;
+        json << ", \"line_bytes\": " << cache.line_bytes;
+        json << ", \"ways\": " << cache.ways << ", \"cpus\": ";
+        write_list(cache.cpus);
+        json << "}" << (i < topology.caches.size() - 1 ? ",\n" : "\n");
+    }
+    json << "    ],\n";
+    json << "    \"numa_nodes\": [\n";
+    for (size_t i = 0; i < topology.nodes.size(); ++i) {
+        const auto& node = topology.nodes[i];
+        json << "      {\"node\": " << node.id << ", \"memory_total_mib\": " << node.memory_total_bytes / (1024 * 1024);
+        json << ", \"cpus\": ";
+        write_list(node.cpus);
+        json << ", \"distances\": ";
+        write_list(node.distances);
+        json << "}" << (i < topology.nodes.size() - 1 ? ",\n" : "\n");
+    }
+    json << "    ]\n";
+    json << "  },\n";
+    
     // RAM Information
     json << "  \"ram\": {\n";
     hwinfo::Memory ram;
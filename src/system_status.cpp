@@ -3,52 +3,840 @@
 #include <hwinfo/hwinfo.h>
 #include <hwinfo/cpu.h>
 #include <hwinfo/gpu.h>
-#include <hwinfo/disk.h>
-#include <hwinfo/ram.h>
-#include <fstream>
+#include <cstdlib>
 #include <sstream>
 #include <string>
 #include <chrono>
 #include <thread>
 #include <iomanip>
+#include <memory>
+#include <mutex>
+#include <cstring>
+#include <cerrno>
+#include "net_stats.h"
+#include "disk_io_stats.h"
+#include "filesystem_stats.h"
+#include "psi_stats.h"
+#include "thermal_stats.h"
+#include "cpufreq_stats.h"
+#include "process_stats.h"
+#include "cgroup_stats.h"
+#include "perf_stats.h"
+#include "power_stats.h"
+#include "mem_stats.h"
+#include "sched_stats.h"
+#include "topology.h"
+#include "collector_registry.h"
+#include "status_sampler.h"
+#include <unistd.h>
 
-// Read CPU usage from /proc/stat (Linux)
-double get_cpu_usage() {
-    static long long last_idle = 0, last_total = 0;
+static AppConfig g_status_config = get_default_config();
+
+void configure_system_status(const AppConfig& config) {
+    g_status_config = config;
+}
+
+// Write one PSI resource as {"some": {...}, "full": {...}}
+static void write_psi_resource(std::ostringstream& json, const PsiResource& res, const std::string& indent) {
+    auto write_line = [&](const char* key, const PsiLine& line, bool last) {
+        json << indent << "  \"" << key << "\": {";
+        json << "\"avg10\": " << std::fixed << std::setprecision(2) << line.avg10 << ", ";
+        json << "\"avg60\": " << line.avg60 << ", ";
+        json << "\"avg300\": " << line.avg300 << ", ";
+        json << "\"total_us\": " << line.total_us << "}" << (last ? "\n" : ",\n");
+    };
+    json << "{\n";
+    write_line("some", res.some, !res.has_full);
+    if (res.has_full) {
+        write_line("full", res.full, true);
+    }
+    json << indent << "}";
+}
+
+// CPU model, clocks and usage, followed by the scheduler section; both come from one /proc/stat read
+class CpuStatus : public StatusCollector {
+public:
+    CpuStatus()
+        : StatusCollector("cpu", 1000),
+          // Model, core counts and max clock don't change; query hwinfo once
+          cpus_(hwinfo::getAllCPUs()) {}
+    
+    void collect(std::ostringstream& json) override {
+        sched_collector_.collect();
+        
+        json << "  \"cpu\": {\n";
+        if (!cpus_.empty()) {
+            const auto& cpu = cpus_[0];
+            double cpu_usage = sched_collector_.cpu_usage_percent();
+            int64_t current_freq = 0;
+            if (cpufreq_collector_.collect() && !cpufreq_collector_.cores().empty()) {
+                current_freq = cpufreq_collector_.cores()[0].cur_khz / 1000;
+            } else {
+                // No cpufreq driver (common in VMs): fall back to hwinfo
+                auto current_freqs = cpu.currentClockSpeed_MHz();
+                current_freq = current_freqs.empty() ? 0 : current_freqs[0];
+            }
+            json << "    \"current_frequency_mhz\": " << current_freq << ",\n";
+            json << "    \"max_frequency_mhz\": " << cpu.maxClockSpeed_MHz() << ",\n";
+            json << "    \"usage_percent\": " << (cpu_usage >= 0 ? cpu_usage : -1) << ",\n";
+            json << "    \"physical_cores\": " << cpu.numPhysicalCores() << ",\n";
+            json << "    \"logical_cores\": " << cpu.numLogicalCores() << ",\n";
+            
+            // Per-core current frequency
+            json << "    \"cores\": [";
+            const auto& cores = cpufreq_collector_.cores();
+            for (size_t i = 0; i < cores.size(); ++i) {
+                if (i > 0) json << ", ";
+                json << "{\"cpu\": " << cores[i].cpu << ", \"frequency_mhz\": " << cores[i].cur_khz / 1000 << "}";
+            }
+            json << "],\n";
+            
+            // Frequency domains (clusters): CPUs that share one clock
+            json << "    \"clusters\": [";
+            const auto& policies = cpufreq_collector_.policies();
+            for (size_t i = 0; i < policies.size(); ++i) {
+                const auto& policy = policies[i];
+                json << (i > 0 ? ",\n" : "\n");
+                json << "      {\"policy\": \"" << policy.name << "\", \"cpus\": [";
+                for (size_t c = 0; c < policy.cpus.size(); ++c) {
+                    json << (c > 0 ? ", " : "") << policy.cpus[c];
+                }
+                json << "], \"frequency_mhz\": " << policy.cur_khz / 1000;
+                json << ", \"min_mhz\": " << policy.scaling_min_khz / 1000;
+                json << ", \"max_mhz\": " << policy.scaling_max_khz / 1000;
+                json << ", \"hardware_min_mhz\": " << policy.cpuinfo_min_khz / 1000;
+                json << ", \"hardware_max_mhz\": " << policy.cpuinfo_max_khz / 1000;
+                json << ", \"governor\": \"" << escape_json(policy.governor) << "\"}";
+            }
+            json << (policies.empty() ? "]\n" : "\n    ]\n");
+        } else {
+            json << "    \"error\": \"No CPU information available\"\n";
+        }
+        json << "  },\n";
+        
+        // Scheduler and kernel activity (rates since the previous collection)
+        json << "  \"scheduler\": {\n";
+        const ProcStat& stat = sched_collector_.stat();
+        const LoadAvg& load = sched_collector_.loadavg();
+        
+        json << "    \"loadavg\": [" << std::fixed << std::setprecision(2) << load.load1 << ", "
+             << load.load5 << ", " << load.load15 << "],\n";
+        json << "    \"runnable_tasks\": " << load.runnable << ",\n";
+        json << "    \"total_tasks\": " << load.total << ",\n";
+        json << "    \"procs_running\": " << stat.procs_running << ",\n";
+        json << "    \"procs_blocked\": " << stat.procs_blocked << ",\n";
+        json << "    \"context_switches\": " << stat.context_switches << ",\n";
+        json << "    \"context_switches_per_sec\": " << sched_collector_.context_switches_per_sec() << ",\n";
+        json << "    \"interrupts\": " << stat.interrupts << ",\n";
+        json << "    \"interrupts_per_sec\": " << sched_collector_.interrupts_per_sec() << ",\n";
+        json << "    \"forks_per_sec\": " << sched_collector_.forks_per_sec() << ",\n";
+        
+        json << "    \"cpu_usage_percent\": [";
+        const auto& per_cpu = sched_collector_.per_cpu_usage_percent();
+        for (size_t i = 0; i < per_cpu.size(); ++i) {
+            json << (i > 0 ? ", " : "") << per_cpu[i];
+        }
+        json << "],\n";
+        
+        json << "    \"softirqs_per_sec\": {";
+        const auto& softirqs = sched_collector_.softirqs();
+        for (size_t i = 0; i < softirqs.size(); ++i) {
+            json << (i > 0 ? ", " : "") << "\"" << escape_json(softirqs[i].name) << "\": " << softirqs[i].per_sec;
+        }
+        json << "},\n";
+        
+        // Per-CPU packet processing: one hot CPU here means RSS/RPS is not spreading the load
+        const auto& softirq_cpus = sched_collector_.softirq_cpus();
+        const char* const net_rows[] = {"NET_RX", "NET_TX"};
+        for (int n = 0; n < 2; ++n) {
+            const SoftirqRow* row = sched_collector_.find_softirq(net_rows[n]);
+            json << "    \"" << (n == 0 ? "net_rx" : "net_tx") << "_per_cpu\": [";
+            for (size_t i = 0; row != nullptr && i < row->per_cpu.size() && i < softirq_cpus.size(); ++i) {
+                json << (i > 0 ? ", " : "") << "{\"cpu\": " << softirq_cpus[i];
+                json << ", \"total\": " << row->per_cpu[i];
+                json << ", \"per_sec\": " << row->per_cpu_per_sec[i] << "}";
+            }
+            json << (n == 0 ? "],\n" : "]\n");
+        }
+        json << "  }";
+    }
+    
+private:
+    std::vector<hwinfo::CPU> cpus_;
+    SchedCollector sched_collector_;
+    CpuFreqCollector cpufreq_collector_;
+};
+
+// RAM Status (/proc/meminfo and /proc/vmstat; rates since the previous collection)
+class RamStatus : public StatusCollector {
+public:
+    RamStatus()
+        : StatusCollector("ram", 1000) {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"ram\": {\n";
+        mem_collector_.collect();
+        const MeminfoValues& mem = mem_collector_.meminfo();
+        
+        const long long mib = 1024 * 1024;
+        long long total_mib = mem.bytes[kMemTotal] / mib;
+        long long free_mib = mem.bytes[kMemFree] / mib;
+        // MemAvailable is missing before Linux 3.14; approximate it like free(1) did
+        long long available_mib = mem.present[kMemAvailable] ? mem.bytes[kMemAvailable] / mib
+            : (mem.bytes[kMemFree] + mem.bytes[kMemBuffers] + mem.bytes[kMemCached]) / mib;
+        long long used_mib = total_mib - available_mib;
+        double usage_percent = total_mib > 0 ? (100.0 * used_mib / total_mib) : 0.0;
+        
+        json << "    \"total_mib\": " << total_mib << ",\n";
+        json << "    \"used_mib\": " << used_mib << ",\n";
+        json << "    \"free_mib\": " << free_mib << ",\n";
+        json << "    \"available_mib\": " << available_mib << ",\n";
+        json << "    \"usage_percent\": " << std::fixed << std::setprecision(2) << usage_percent << ",\n";
+        
+        json << "    \"meminfo_bytes\": {";
+        for (int i = 0; i < kMeminfoFieldCount; ++i) {
+            json << (i == 0 ? "" : ", ") << "\"" << meminfo_field_name((MeminfoField)i) << "\": "
+                 << (mem.present[i] ? (long long)mem.bytes[i] : -1);
+        }
+        json << "},\n";
+        
+        long long swap_used = (long long)(mem.bytes[kMemSwapTotal] - mem.bytes[kMemSwapFree]);
+        json << "    \"swap\": {\"total_mib\": " << mem.bytes[kMemSwapTotal] / mib;
+        json << ", \"used_mib\": " << swap_used / mib;
+        json << ", \"usage_percent\": " << (mem.bytes[kMemSwapTotal] > 0 ? 100.0 * swap_used / mem.bytes[kMemSwapTotal] : 0.0);
+        json << ", \"swap_in_pages_per_sec\": " << mem_collector_.vmstat_rate(kVmPswpin);
+        json << ", \"swap_out_pages_per_sec\": " << mem_collector_.vmstat_rate(kVmPswpout) << "},\n";
+        
+        // Counters since boot and their rates; -1 when the kernel does not report one
+        const VmstatValues& vm = mem_collector_.vmstat();
+        json << "    \"vmstat\": {\n";
+        for (int i = 0; i < kVmstatFieldCount; ++i) {
+            json << "      \"" << vmstat_field_name((VmstatField)i) << "\": {\"total\": "
+                 << (vm.present[i] ? (long long)vm.counts[i] : -1)
+                 << ", \"per_sec\": " << mem_collector_.vmstat_rate((VmstatField)i) << "}";
+            json << (i < kVmstatFieldCount - 1 ? ",\n" : "\n");
+        }
+        json << "    },\n";
+        
+        // Per-node free memory: a full node forces remote allocations even when total RAM is fine
+        numa_collector_.collect();
+        json << "    \"numa_nodes\": [";
+        const auto& nodes = numa_collector_.nodes();
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const auto& node = nodes[i];
+            json << (i > 0 ? ",\n" : "\n");
+            json << "      {\"node\": " << node.node << ", \"total_mib\": " << node.total_bytes / mib;
+            json << ", \"free_mib\": " << node.free_bytes / mib;
+            json << ", \"file_pages_mib\": " << node.file_pages_bytes / mib;
+            json << ", \"usage_percent\": " << (node.total_bytes > 0
+                ? 100.0 * (node.total_bytes - node.free_bytes) / node.total_bytes : 0.0) << "}";
+        }
+        json << (nodes.empty() ? "]\n" : "\n    ]\n");
+        json << "  }";
+    }
+    
+private:
+    MemoryCollector mem_collector_;
+    NumaMemoryCollector numa_collector_;
+};
+
+// Disk Status (statvfs per mounted filesystem; mount table re-parsed only on change)
+class DisksStatus : public StatusCollector {
+public:
+    DisksStatus()
+        : StatusCollector("disks", 30000) {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"disks\": [\n";
+        fs_collector_.collect();
+        
+        bool first = true;
+        size_t id = 0;
+        for (const auto& fs : fs_collector_.filesystems()) {
+            if (!fs.ok || fs.total_bytes == 0) continue;
+            // Same convention as df: used / (used + available to users)
+            unsigned long long usable = fs.used_bytes + fs.available_bytes;
+            double usage_percent = usable > 0 ? (100.0 * fs.used_bytes / usable) : 0.0;
+            unsigned long long inodes_used = fs.inodes_total - fs.inodes_free;
+            double inodes_percent = fs.inodes_total > 0 ? (100.0 * inodes_used / fs.inodes_total) : 0.0;
+            
+            if (!first) json << ",\n";
+            first = false;
+            json << "    {\n";
+            json << "      \"id\": " << id++ << ",\n";
+            json << "      \"model\": \"" << escape_json(fs.model) << "\",\n";
+            json << "      \"device\": \"" << escape_json(fs.device) << "\",\n";
+            json << "      \"mount_point\": \"" << escape_json(fs.mount_point) << "\",\n";
+            json << "      \"fs_type\": \"" << escape_json(fs.fs_type) << "\",\n";
+            json << "      \"total_bytes\": " << fs.total_bytes << ",\n";
+            json << "      \"used_bytes\": " << fs.used_bytes << ",\n";
+            json << "      \"free_bytes\": " << fs.available_bytes << ",\n";
+            json << "      \"usage_percent\": " << std::fixed << std::setprecision(2) << usage_percent << ",\n";
+            json << "      \"inodes_total\": " << fs.inodes_total << ",\n";
+            json << "      \"inodes_used\": " << inodes_used << ",\n";
+            json << "      \"inodes_usage_percent\": " << inodes_percent << "\n";
+            json << "    }";
+        }
+        if (!first) json << "\n";
+        json << "  ]";
+    }
     
-    std::ifstream stat_file("/proc/stat");
-    if (!stat_file.is_open()) {
-        return -1.0;
+private:
+    FilesystemCollector fs_collector_;
+};
+
+// Disk I/O (rates since the previous collection)
+class DiskIoStatus : public StatusCollector {
+public:
+    explicit DiskIoStatus(const DiskIoConfig& config)
+        : StatusCollector("disk_io", 1000),
+          disk_io_collector_(config.include_partitions) {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"disk_io\": [\n";
+        disk_io_collector_.collect();
+        
+        bool first = true;
+        for (const auto& dev : disk_io_collector_.devices()) {
+            if (!dev.present) continue;
+            if (!first) json << ",\n";
+            first = false;
+            json << "    {\n";
+            json << "      \"name\": \"" << escape_json(dev.name) << "\",\n";
+            json << "      \"partition\": " << (dev.is_partition ? "true" : "false") << ",\n";
+            json << "      \"reads_completed\": " << dev.reads_completed << ",\n";
+            json << "      \"writes_completed\": " << dev.writes_completed << ",\n";
+            json << "      \"read_bytes\": " << dev.sectors_read * 512 << ",\n";
+            json << "      \"write_bytes\": " << dev.sectors_written * 512 << ",\n";
+            json << "      \"ios_in_progress\": " << dev.ios_in_progress << ",\n";
+            json << "      \"reads_per_sec\": " << std::fixed << std::setprecision(2) << dev.reads_per_sec << ",\n";
+            json << "      \"writes_per_sec\": " << dev.writes_per_sec << ",\n";
+            json << "      \"read_bytes_per_sec\": " << dev.read_bytes_per_sec << ",\n";
+            json << "      \"write_bytes_per_sec\": " << dev.write_bytes_per_sec << ",\n";
+            json << "      \"read_await_ms\": " << dev.read_await_ms << ",\n";
+            json << "      \"write_await_ms\": " << dev.write_await_ms << ",\n";
+            json << "      \"await_ms\": " << dev.await_ms << ",\n";
+            json << "      \"util_percent\": " << dev.util_percent << "\n";
+            json << "    }";
+        }
+        if (!first) json << "\n";
+        json << "  ]";
     }
     
-    std::string line;
-    std::getline(stat_file, line);
-    stat_file.close();
+private:
+    DiskIoCollector disk_io_collector_;
+};
+
+// GPU Status (hwinfo enumerates devices on every call, so this runs less often)
+class GpuStatus : public StatusCollector {
+public:
+    GpuStatus()
+        : StatusCollector("gpu", 5000) {}
     
-    std::istringstream iss(line);
-    std::string cpu;
-    long long user, nice, system, idle, iowait, irq, softirq, steal, guest, guest_nice;
+    void collect(std::ostringstream& json) override {
+        json << "  \"gpu\": [\n";
+        auto gpus = hwinfo::getAllGPUs();
+        for (size_t i = 0; i < gpus.size(); ++i) {
+            const auto& gpu = gpus[i];
+            json << "    {\n";
+            json << "      \"id\": " << i << ",\n";
+            json << "      \"model\": \"" << escape_json(gpu.name()) << "\",\n";
+            json << "      \"memory_mib\": " << gpu.memory_Bytes() / (1024 * 1024) << ",\n";
+            json << "      \"frequency_mhz\": " << gpu.frequency_MHz() << "\n";
+            json << "    }";
+            if (i < gpus.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "  ]";
+    }
+};
+
+// Hardware performance counters (optional; collected once when disabled)
+class PerfStatus : public StatusCollector {
+public:
+    explicit PerfStatus(const PerfConfig& config)
+        : StatusCollector("perf", config.enabled ? 1000 : 0) {
+        if (config.enabled) {
+            perf_collector_.reset(new PerfCollector(config.system_wide, config.cgroups));
+        }
+    }
     
-    iss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal >> guest >> guest_nice;
+    void collect(std::ostringstream& json) override {
+        json << "  \"perf\": {\n";
+        if (!perf_collector_) {
+            json << "    \"enabled\": false\n";
+        } else {
+            perf_collector_->collect();
+            
+            json << "    \"enabled\": true,\n";
+            json << "    \"mode\": \"" << perf_collector_->mode() << "\",\n";
+            if (!perf_collector_->error().empty()) {
+                json << "    \"error\": \"" << escape_json(perf_collector_->error()) << "\",\n";
+            }
+            json << "    \"targets\": [\n";
+            const auto& targets = perf_collector_->targets();
+            for (size_t i = 0; i < targets.size(); ++i) {
+                const auto& target = targets[i];
+                json << "      {\"name\": \"" << escape_json(target.name) << "\"";
+                json << ", \"available\": " << (target.available ? "true" : "false");
+                if (target.available) {
+                    json << std::fixed << std::setprecision(3);
+                    if (perf_collector_->mode() == "hardware") {
+                        json << ", \"ipc\": " << target.ipc;
+                        json << ", \"cache_misses_per_kinstr\": " << target.cache_misses_per_kinstr;
+                        json << ", \"branch_misses_per_kinstr\": " << target.branch_misses_per_kinstr;
+                    } else {
+                        json << ", \"cpu_migrations_per_sec\": " << target.cpu_migrations_per_sec;
+                        json << ", \"page_faults_per_sec\": " << target.page_faults_per_sec;
+                    }
+                    json << ", \"context_switches_per_sec\": " << target.context_switches_per_sec;
+                    json << ", \"running_ratio\": " << target.running_ratio;
+                }
+                json << "}";
+                if (i < targets.size() - 1) json << ",";
+                json << "\n";
+            }
+            json << "    ]\n";
+        }
+        json << "  }";
+    }
     
-    long long total = user + nice + system + idle + iowait + irq + softirq + steal;
-    long long total_idle = idle + iowait;
+private:
+    std::unique_ptr<PerfCollector> perf_collector_;
+};
+
+// Network interface throughput (rates since the previous collection)
+class NetworkStatus : public StatusCollector {
+public:
+    NetworkStatus()
+        : StatusCollector("network", 1000) {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"network\": [\n";
+        net_collector_.collect();
+        
+        bool first = true;
+        for (const auto& iface : net_collector_.interfaces()) {
+            if (!iface.present) continue;
+            if (!first) json << ",\n";
+            first = false;
+            json << "    {\n";
+            json << "      \"name\": \"" << escape_json(iface.name) << "\",\n";
+            json << "      \"rx_bytes\": " << iface.rx_bytes << ",\n";
+            json << "      \"rx_packets\": " << iface.rx_packets << ",\n";
+            json << "      \"rx_errors\": " << iface.rx_errors << ",\n";
+            json << "      \"rx_dropped\": " << iface.rx_dropped << ",\n";
+            json << "      \"tx_bytes\": " << iface.tx_bytes << ",\n";
+            json << "      \"tx_packets\": " << iface.tx_packets << ",\n";
+            json << "      \"tx_errors\": " << iface.tx_errors << ",\n";
+            json << "      \"tx_dropped\": " << iface.tx_dropped << ",\n";
+            json << "      \"rx_bytes_per_sec\": " << std::fixed << std::setprecision(2) << iface.rx_bytes_per_sec << ",\n";
+            json << "      \"tx_bytes_per_sec\": " << iface.tx_bytes_per_sec << ",\n";
+            json << "      \"rx_packets_per_sec\": " << iface.rx_packets_per_sec << ",\n";
+            json << "      \"tx_packets_per_sec\": " << iface.tx_packets_per_sec << ",\n";
+            json << "      \"rx_errors_per_sec\": " << iface.rx_errors_per_sec << ",\n";
+            json << "      \"tx_errors_per_sec\": " << iface.tx_errors_per_sec << ",\n";
+            json << "      \"rx_dropped_per_sec\": " << iface.rx_dropped_per_sec << ",\n";
+            json << "      \"tx_dropped_per_sec\": " << iface.tx_dropped_per_sec << "\n";
+            json << "    }";
+        }
+        if (!first) json << "\n";
+        json << "  ]";
+    }
     
-    if (last_total == 0) {
-        last_idle = total_idle;
-        last_total = total;
-        return -1.0; // First call, need second measurement
+private:
+    NetDevCollector net_collector_;
+};
+
+// TCP/UDP protocol counters and socket counts (rates since the previous collection)
+class ProtocolsStatus : public StatusCollector {
+public:
+    ProtocolsStatus()
+        : StatusCollector("protocols", 1000) {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"protocols\": {\n";
+        proto_collector_.collect();
+        
+        const char* const groups[] = {"tcp", "udp"};
+        for (const char* group : groups) {
+            json << "    \"" << group << "\": {\n";
+            bool first = true;
+            for (int i = 0; i < kNetProtoCounterCount; ++i) {
+                NetProtoCounter counter = (NetProtoCounter)i;
+                if (std::strcmp(NetProtoCollector::counter_group(counter), group) != 0 || !proto_collector_.has(counter)) {
+                    continue;
+                }
+                if (!first) json << ",\n";
+                first = false;
+                const char* name = NetProtoCollector::counter_name(counter);
+                json << "      \"" << name << "\": " << proto_collector_.value(counter);
+                if (!NetProtoCollector::counter_is_gauge(counter)) {
+                    json << ",\n      \"" << name << "_per_sec\": " << std::fixed << std::setprecision(2)
+                         << proto_collector_.rate(counter);
+                }
+            }
+            if (std::strcmp(group, "tcp") == 0) {
+                json << (first ? "" : ",\n") << "      \"retransmit_percent\": " << std::fixed << std::setprecision(2)
+                     << proto_collector_.tcp_retransmit_percent();
+                first = false;
+            }
+            json << (first ? "" : "\n") << "    },\n";
+        }
+        
+        const SockStat& sockets = proto_collector_.sockstat();
+        json << "    \"sockets\": {\"used\": " << sockets.sockets_used;
+        json << ", \"tcp_inuse\": " << sockets.tcp_inuse;
+        json << ", \"tcp_orphan\": " << sockets.tcp_orphan;
+        json << ", \"tcp_time_wait\": " << sockets.tcp_time_wait;
+        json << ", \"tcp_alloc\": " << sockets.tcp_alloc;
+        json << ", \"tcp_mem_pages\": " << sockets.tcp_mem_pages;
+        json << ", \"udp_inuse\": " << sockets.udp_inuse;
+        json << ", \"udp_mem_pages\": " << sockets.udp_mem_pages;
+        json << ", \"tcp6_inuse\": " << sockets.tcp6_inuse;
+        json << ", \"udp6_inuse\": " << sockets.udp6_inuse << "}\n";
+        json << "  }";
     }
     
-    long long total_diff = total - last_total;
-    long long idle_diff = total_idle - last_idle;
+private:
+    NetProtoCollector proto_collector_;
+};
+
+// Thermal zones, cooling devices and hwmon sensors
+class ThermalStatus : public StatusCollector {
+public:
+    ThermalStatus()
+        : StatusCollector("thermal", 1000) {}
     
-    last_idle = total_idle;
-    last_total = total;
+    void collect(std::ostringstream& json) override {
+        json << "  \"thermal\": {\n";
+        thermal_collector_.collect();
+        
+        json << "    \"throttling\": " << (thermal_collector_.throttling() ? "true" : "false") << ",\n";
+        json << "    \"throttle_reason\": \"" << escape_json(thermal_collector_.throttle_reason()) << "\",\n";
+        
+        json << "    \"zones\": [\n";
+        const auto& zones = thermal_collector_.zones();
+        for (size_t i = 0; i < zones.size(); ++i) {
+            const auto& zone = zones[i];
+            json << "      {\n";
+            json << "        \"name\": \"" << escape_json(zone.name) << "\",\n";
+            json << "        \"type\": \"" << escape_json(zone.type) << "\",\n";
+            json << "        \"temperature_c\": " << std::fixed << std::setprecision(1)
+                 << (zone.ok ? zone.temp_millicelsius / 1000.0 : -1.0) << ",\n";
+            json << "        \"trip_points\": [";
+            for (size_t t = 0; t < zone.trip_points.size(); ++t) {
+                json << "{\"type\": \"" << escape_json(zone.trip_points[t].type) << "\", \"temperature_c\": "
+                     << zone.trip_points[t].temp_millicelsius / 1000.0 << "}";
+                if (t < zone.trip_points.size() - 1) json << ", ";
+            }
+            json << "]\n";
+            json << "      }";
+            if (i < zones.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "    ],\n";
+        
+        json << "    \"cooling_devices\": [\n";
+        const auto& cooling = thermal_collector_.cooling_devices();
+        for (size_t i = 0; i < cooling.size(); ++i) {
+            json << "      {\"name\": \"" << escape_json(cooling[i].name) << "\", ";
+            json << "\"type\": \"" << escape_json(cooling[i].type) << "\", ";
+            json << "\"cur_state\": " << cooling[i].cur_state << ", ";
+            json << "\"max_state\": " << cooling[i].max_state << "}";
+            if (i < cooling.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "    ],\n";
+        
+        json << "    \"sensors\": [\n";
+        const auto& sensors = thermal_collector_.sensors();
+        bool first = true;
+        for (const auto& sensor : sensors) {
+            if (!sensor.ok) continue;
+            if (!first) json << ",\n";
+            first = false;
+            json << "      {\"chip\": \"" << escape_json(sensor.chip) << "\", ";
+            json << "\"label\": \"" << escape_json(sensor.label) << "\", ";
+            json << "\"kind\": \"" << sensor.kind << "\", ";
+            json << "\"value\": " << std::setprecision(3) << sensor.value << "}";
+        }
+        if (!first) json << "\n";
+        json << "    ],\n";
+        
+        json << "    \"cpufreq\": [\n";
+        const auto& limits = thermal_collector_.cpufreq_limits();
+        for (size_t i = 0; i < limits.size(); ++i) {
+            json << "      {\"policy\": \"" << limits[i].policy << "\", ";
+            json << "\"cur_khz\": " << limits[i].cur_khz << ", ";
+            json << "\"scaling_max_khz\": " << limits[i].scaling_max_khz << ", ";
+            json << "\"cpuinfo_max_khz\": " << limits[i].cpuinfo_max_khz << ", ";
+            json << "\"capped\": " << (limits[i].capped ? "true" : "false") << "}";
+            if (i < limits.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "    ]\n";
+        json << "  }";
+    }
     
-    if (total_diff == 0) return 0.0;
+private:
+    ThermalCollector thermal_collector_;
+};
+
+// Power: RAPL domains (watts from energy deltas), power supplies, hwmon power monitors
+class PowerStatus : public StatusCollector {
+public:
+    PowerStatus()
+        : StatusCollector("power", 1000) {}
     
-    return 100.0 * (1.0 - (double)idle_diff / total_diff);
+    void collect(std::ostringstream& json) override {
+        json << "  \"power\": {\n";
+        power_collector_.collect();
+        
+        json << std::fixed << std::setprecision(2);
+        json << "    \"package_watts\": " << power_collector_.package_watts() << ",\n";
+        json << "    \"domains\": [\n";
+        const auto& domains = power_collector_.domains();
+        for (size_t i = 0; i < domains.size(); ++i) {
+            const auto& domain = domains[i];
+            json << "      {\"zone\": \"" << escape_json(domain.zone) << "\", \"name\": \"" << escape_json(domain.name) << "\"";
+            if (domain.ok) {
+                json << ", \"watts\": " << domain.watts << ", \"energy_uj\": " << domain.energy_uj << "}";
+            } else {
+                json << ", \"error\": \"energy_uj not readable\"}";
+            }
+            if (i < domains.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "    ],\n";
+        
+        json << "    \"supplies\": [\n";
+        const auto& supplies = power_collector_.supplies();
+        for (size_t i = 0; i < supplies.size(); ++i) {
+            const auto& supply = supplies[i];
+            json << "      {\"name\": \"" << escape_json(supply.name) << "\", \"type\": \"" << escape_json(supply.type) << "\"";
+            if (!supply.status.empty()) json << ", \"status\": \"" << escape_json(supply.status) << "\"";
+            if (supply.online >= 0) json << ", \"online\": " << (supply.online ? "true" : "false");
+            if (supply.capacity_percent >= 0) json << ", \"capacity_percent\": " << supply.capacity_percent;
+            json << ", \"watts\": " << supply.watts << "}";
+            if (i < supplies.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "    ],\n";
+        
+        json << "    \"sensors\": [\n";
+        const auto& sensors = power_collector_.sensors();
+        for (size_t i = 0; i < sensors.size(); ++i) {
+            json << "      {\"chip\": \"" << escape_json(sensors[i].chip) << "\", ";
+            json << "\"label\": \"" << escape_json(sensors[i].label) << "\", ";
+            json << "\"watts\": " << std::setprecision(3) << (sensors[i].ok ? sensors[i].watts : -1.0) << "}";
+            if (i < sensors.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "    ]\n";
+        json << "  }";
+    }
+    
+private:
+    PowerCollector power_collector_;
+};
+
+// Pressure Stall Information (kernel-averaged, no deltas needed)
+class PressureStatus : public StatusCollector {
+public:
+    explicit PressureStatus(const PsiConfig& config)
+        : StatusCollector("pressure", 1000),
+          psi_collector_(config.cgroups) {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"pressure\": {\n";
+        bool available = psi_collector_.collect();
+        
+        json << "    \"available\": " << (available ? "true" : "false") << ",\n";
+        for (const auto& res : psi_collector_.system()) {
+            if (!res.available) continue;
+            json << "    \"" << res.name << "\": ";
+            write_psi_resource(json, res, "    ");
+            json << ",\n";
+        }
+        json << "    \"cgroups\": [\n";
+        const auto& cgroups = psi_collector_.cgroups();
+        for (size_t i = 0; i < cgroups.size(); ++i) {
+            json << "      {\n";
+            json << "        \"path\": \"" << escape_json(cgroups[i].path) << "\"";
+            for (const auto& res : cgroups[i].resources) {
+                if (!res.available) continue;
+                json << ",\n        \"" << res.name << "\": ";
+                write_psi_resource(json, res, "        ");
+            }
+            json << "\n      }";
+            if (i < cgroups.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "    ],\n";
+        json << "    \"trigger_events\": " << get_psi_trigger_event_count() << "\n";
+        json << "  }";
+    }
+    
+private:
+    PsiCollector psi_collector_;
+};
+
+// cgroup v2 accounting for configured services/containers
+class CgroupsStatus : public StatusCollector {
+public:
+    explicit CgroupsStatus(const CgroupStatsConfig& config)
+        : StatusCollector("cgroups", 1000),
+          cgroup_collector_(config.paths) {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"cgroups\": [\n";
+        cgroup_collector_.collect();
+        
+        const auto& cgroups = cgroup_collector_.cgroups();
+        for (size_t i = 0; i < cgroups.size(); ++i) {
+            const auto& cg = cgroups[i];
+            json << "    {\n";
+            json << "      \"path\": \"" << escape_json(cg.path) << "\",\n";
+            if (!cg.available) {
+                json << "      \"error\": \"cgroup not found\"\n";
+            } else {
+                json << std::fixed << std::setprecision(2);
+                json << "      \"cpu\": {\"usage_percent\": " << cg.cpu_percent;
+                json << ", \"throttled_percent\": " << cg.throttled_percent;
+                json << ", \"usage_usec\": " << cg.cpu_usage_usec;
+                json << ", \"user_usec\": " << cg.cpu_user_usec;
+                json << ", \"system_usec\": " << cg.cpu_system_usec;
+                json << ", \"nr_throttled\": " << cg.nr_throttled << "},\n";
+                json << "      \"memory\": {\"current_bytes\": " << cg.memory_current_bytes;
+                json << ", \"max_bytes\": " << cg.memory_max_bytes;
+                json << ", \"anon_bytes\": " << cg.memory_anon_bytes;
+                json << ", \"file_bytes\": " << cg.memory_file_bytes;
+                json << ", \"kernel_bytes\": " << cg.memory_kernel_bytes;
+                json << ", \"pgmajfault\": " << cg.pgmajfault << "},\n";
+                json << "      \"io\": {\"read_bytes\": " << cg.io_read_bytes;
+                json << ", \"write_bytes\": " << cg.io_write_bytes;
+                json << ", \"read_bytes_per_sec\": " << cg.io_read_bytes_per_sec;
+                json << ", \"write_bytes_per_sec\": " << cg.io_write_bytes_per_sec;
+                json << ", \"read_iops\": " << cg.io_read_iops;
+                json << ", \"write_iops\": " << cg.io_write_iops << "},\n";
+                json << "      \"pids\": " << cg.pids_current << "\n";
+            }
+            json << "    }";
+            if (i < cgroups.size() - 1) json << ",";
+            json << "\n";
+        }
+        json << "  ]";
+    }
+    
+private:
+    CgroupCollector cgroup_collector_;
+};
+
+// CPU/NUMA layout summary; the full layout is in the system info
+class TopologyStatus : public StatusCollector {
+public:
+    TopologyStatus()
+        : StatusCollector("topology", 0) {}
+    
+    void collect(std::ostringstream& json) override {
+        const CpuTopology& topology = get_cpu_topology();
+        json << "  \"topology\": {\"packages\": " << topology.packages;
+        json << ", \"cores\": " << topology.cores;
+        json << ", \"logical_cpus\": " << topology.cpus.size();
+        json << ", \"smt_active\": " << (topology.smt_active ? "true" : "false");
+        json << ", \"numa_nodes\": " << topology.nodes.size() << "}";
+    }
+};
+
+// System uptime from /proc/uptime (kept open, one pread per pass)
+class UptimeStatus : public StatusCollector {
+public:
+    UptimeStatus()
+        : StatusCollector("uptime", 1000),
+          uptime_reader_(host_proc_root() + "/uptime") {}
+    
+    void collect(std::ostringstream& json) override {
+        json << "  \"uptime\": {\n";
+        if (uptime_reader_.read()) {
+            double uptime_seconds = std::strtod(uptime_reader_.data(), nullptr);
+            int days = (int)(uptime_seconds / 86400);
+            int hours = (int)((uptime_seconds - days * 86400) / 3600);
+            int minutes = (int)((uptime_seconds - days * 86400 - hours * 3600) / 60);
+            
+            json << "    \"seconds\": " << (long long)uptime_seconds << ",\n";
+            json << "    \"days\": " << days << ",\n";
+            json << "    \"hours\": " << hours << ",\n";
+            json << "    \"minutes\": " << minutes << "\n";
+        } else {
+            json << "    \"error\": \"Unable to read uptime\"\n";
+        }
+        json << "  }";
+    }
+    
+private:
+    ProcFileReader uptime_reader_;
+};
+
+static std::mutex g_registry_mutex;
+static std::unique_ptr<CollectorRegistry> g_registry;
+
+static std::unique_ptr<CollectorRegistry> build_registry(const AppConfig& config) {
+    std::unique_ptr<CollectorRegistry> registry(new CollectorRegistry(config.collectors.cpu_budget_percent));
+    // Only /status reads the registry: back off like the sampler while nobody asks
+    if (config.sampler.idle_interval_ms > config.sampler.interval_ms) {
+        registry->set_idle_backoff(config.sampler.demand_hold_ms, config.sampler.idle_interval_ms);
+    }
+    std::vector<std::unique_ptr<StatusCollector>> collectors;
+    collectors.emplace_back(new CpuStatus());
+    collectors.emplace_back(new RamStatus());
+    collectors.emplace_back(new DisksStatus());
+    collectors.emplace_back(new DiskIoStatus(config.disk_io));
+    collectors.emplace_back(new GpuStatus());
+    collectors.emplace_back(new PerfStatus(config.perf));
+    collectors.emplace_back(new NetworkStatus());
+    collectors.emplace_back(new ProtocolsStatus());
+    collectors.emplace_back(new ThermalStatus());
+    collectors.emplace_back(new PowerStatus());
+    collectors.emplace_back(new PressureStatus(config.psi));
+    collectors.emplace_back(new CgroupsStatus(config.cgroup_stats));
+    collectors.emplace_back(new TopologyStatus());
+    collectors.emplace_back(new UptimeStatus());
+    for (auto& collector : collectors) {
+        for (const auto& interval : config.collectors.intervals_ms) {
+            // A collect-once collector (topology, disabled perf) stays that way
+            if (interval.first == collector->name() && collector->interval_ms() > 0 && interval.second > 0) {
+                collector->set_interval_ms(interval.second);
+            }
+        }
+        for (const auto& budget : config.collectors.cpu_budgets_percent) {
+            if (budget.first == collector->name() && budget.second >= 0) {
+                collector->set_cpu_budget_percent(budget.second);
+            }
+        }
+        registry->add(std::move(collector));
+    }
+    return registry;
+}
+
+// Built from the configured options on first use: start_status_collectors() or the first request
+static CollectorRegistry& get_registry() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    if (!g_registry) {
+        g_registry = build_registry(g_status_config);
+    }
+    return *g_registry;
+}
+
+void start_status_collectors() {
+    get_registry().start();
+}
+
+void stop_status_collectors() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    if (g_registry) {
+        g_registry->stop();
+    }
 }
 
 std::string get_system_status_json() {
@@ -60,101 +848,130 @@ std::string get_system_status_json() {
     auto time_t = std::chrono::system_clock::to_time_t(now);
     json << "  \"timestamp\": \"" << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << "\",\n";
     
-    // CPU Status
-    json << "  \"cpu\": {\n";
-    auto cpus = hwinfo::getAllCPUs();
-    if (!cpus.empty()) {
-        const auto& cpu = cpus[0];
-        double cpu_usage = get_cpu_usage();
-        auto current_freqs = cpu.currentClockSpeed_MHz();
-        int64_t current_freq = current_freqs.empty() ? 0 : current_freqs[0];
-        json << "    \"current_frequency_mhz\": " << current_freq << ",\n";
-        json << "    \"max_frequency_mhz\": " << cpu.maxClockSpeed_MHz() << ",\n";
-        json << "    \"usage_percent\": " << (cpu_usage >= 0 ? cpu_usage : -1) << ",\n";
-        json << "    \"physical_cores\": " << cpu.numPhysicalCores() << ",\n";
-        json << "    \"logical_cores\": " << cpu.numLogicalCores() << "\n";
-    } else {
-        json << "    \"error\": \"No CPU information available\"\n";
+    // Latest output of every collector; nothing is read from /proc or /sys here
+    CollectorRegistry& registry = get_registry();
+    for (const auto& fragment : registry.snapshot()) {
+        json << *fragment << ",\n";
     }
-    json << "  },\n";
-    
-    // RAM Status
-    json << "  \"ram\": {\n";
-    hwinfo::Memory ram;
-    long long total_mib = ram.total_Bytes() / (1024 * 1024);
-    long long free_mib = ram.free_Bytes() / (1024 * 1024);
-    long long available_mib = ram.available_Bytes() / (1024 * 1024);
-    long long used_mib = total_mib - available_mib;
-    double usage_percent = total_mib > 0 ? (100.0 * used_mib / total_mib) : 0.0;
-    
-    json << "    \"total_mib\": " << total_mib << ",\n";
-    json << "    \"used_mib\": " << used_mib << ",\n";
-    json << "    \"free_mib\": " << free_mib << ",\n";
-    json << "    \"available_mib\": " << available_mib << ",\n";
-    json << "    \"usage_percent\": " << std::fixed << std::setprecision(2) << usage_percent << "\n";
-    json << "  },\n";
     
-    // Disk Status
-    json << "  \"disks\": [\n";
-    auto disks = hwinfo::getAllDisks();
-    for (size_t i = 0; i < disks.size(); ++i) {
-        const auto& disk = disks[i];
-        long long total_bytes = disk.size_Bytes();
-        long long free_bytes = disk.free_size_Bytes();
-        long long used_bytes = total_bytes - free_bytes;
-        double usage_percent = total_bytes > 0 ? (100.0 * used_bytes / total_bytes) : 0.0;
-        
-        json << "    {\n";
-        json << "      \"id\": " << i << ",\n";
-        json << "      \"model\": \"" << escape_json(disk.model()) << "\",\n";
-        json << "      \"total_bytes\": " << total_bytes << ",\n";
-        json << "      \"used_bytes\": " << used_bytes << ",\n";
-        json << "      \"free_bytes\": " << free_bytes << ",\n";
-        json << "      \"usage_percent\": " << std::fixed << std::setprecision(2) << usage_percent << "\n";
-        json << "    }";
-        if (i < disks.size() - 1) json << ",";
+    // Scheduling and cost of each collector
+    json << "  \"collectors\": [\n";
+    std::vector<CollectorStats> stats = registry.stats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& s = stats[i];
+        json << "    {\"name\": \"" << s.name << "\"";
+        json << ", \"interval_ms\": " << s.interval_ms;
+        json << ", \"effective_interval_ms\": " << s.effective_interval_ms;
+        json << ", \"runs\": " << s.runs;
+        json << ", \"last_cpu_us\": " << std::fixed << std::setprecision(1) << s.last_cpu_us;
+        json << ", \"avg_cpu_us\": " << s.avg_cpu_us;
+        json << ", \"last_wall_us\": " << s.last_wall_us;
+        json << ", \"cpu_percent\": " << std::setprecision(3) << s.cpu_percent;
+        json << ", \"cpu_budget_percent\": " << s.cpu_budget_percent;
+        json << ", \"age_ms\": " << s.age_ms << "}";
+        if (i < stats.size() - 1) json << ",";
         json << "\n";
     }
     json << "  ],\n";
     
-    // GPU Status
-    json << "  \"gpu\": [\n";
-    auto gpus = hwinfo::getAllGPUs();
-    for (size_t i = 0; i < gpus.size(); ++i) {
-        const auto& gpu = gpus[i];
-        json << "    {\n";
-        json << "      \"id\": " << i << ",\n";
-        json << "      \"model\": \"" << escape_json(gpu.name()) << "\",\n";
-        json << "      \"memory_mib\": " << gpu.memory_Bytes() / (1024 * 1024) << ",\n";
-        json << "      \"frequency_mhz\": " << gpu.frequency_MHz() << "\n";
-        json << "    }";
-        if (i < gpus.size() - 1) json << ",";
-        json << "\n";
+    // Effective rate of the adaptive background sampler (StatsD, shared memory)
+    json << "  \"sampler\": {";
+    StatusSample sample;
+    if (get_latest_status_sample(sample) && sample.sample_interval_ms > 0) {
+        json << "\"interval_ms\": " << sample.sample_interval_ms;
+        json << ", \"rate_hz\": " << std::setprecision(2) << 1000.0 / sample.sample_interval_ms;
+        json << ", \"reason\": \"" << sample.sampling_reason << "\"";
+        json << ", \"sequence\": " << sample.sequence;
+    } else {
+        json << "\"running\": false";
     }
-    json << "  ],\n";
+    json << "}\n";
     
-    // System Uptime (Linux)
-    json << "  \"uptime\": {\n";
-    std::ifstream uptime_file("/proc/uptime");
-    if (uptime_file.is_open()) {
-        double uptime_seconds;
-        uptime_file >> uptime_seconds;
-        uptime_file.close();
-        
-        int days = (int)(uptime_seconds / 86400);
-        int hours = (int)((uptime_seconds - days * 86400) / 3600);
-        int minutes = (int)((uptime_seconds - days * 86400 - hours * 3600) / 60);
-        
-        json << "    \"seconds\": " << (long long)uptime_seconds << ",\n";
-        json << "    \"days\": " << days << ",\n";
-        json << "    \"hours\": " << hours << ",\n";
-        json << "    \"minutes\": " << minutes << "\n";
+    json << "}";
+    return json.str();
+}
+
+
+bool get_instance_metrics_json(const std::string& instance_id, std::string& out) {
+    static std::mutex process_mutex;
+    static InstanceProcessCollector process_collector(g_status_config.instance_bindings);
+    std::lock_guard<std::mutex> lock(process_mutex);
+    
+    const InstanceProcessStats* stats = process_collector.collect(instance_id);
+    if (stats == nullptr) {
+        return false;
+    }
+    
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(2);
+    json << "{\n";
+    json << "  \"id\": \"" << escape_json(stats->id) << "\",\n";
+    json << "  \"bound_by\": \"" << stats->bound_by << "\",\n";
+    json << "  \"running\": " << (stats->pids.empty() ? "false" : "true") << ",\n";
+    json << "  \"pids\": [";
+    for (size_t i = 0; i < stats->pids.size(); ++i) {
+        json << (i > 0 ? ", " : "") << stats->pids[i];
+    }
+    json << "],\n";
+    json << "  \"threads\": " << stats->num_threads << ",\n";
+    json << "  \"cpu\": {\n";
+    json << "    \"usage_percent\": " << stats->cpu_percent << ",\n";
+    json << "    \"time_seconds\": " << (double)stats->cpu_time_ticks / sysconf(_SC_CLK_TCK) << "\n";
+    json << "  },\n";
+    json << "  \"memory\": {\n";
+    json << "    \"rss_bytes\": " << stats->rss_bytes << ",\n";
+    json << "    \"virtual_bytes\": " << stats->vm_bytes << "\n";
+    json << "  },\n";
+    json << "  \"io\": {\n";
+    if (stats->io_available) {
+        json << "    \"read_bytes\": " << stats->read_bytes << ",\n";
+        json << "    \"write_bytes\": " << stats->write_bytes << ",\n";
+        json << "    \"read_bytes_per_sec\": " << stats->read_bytes_per_sec << ",\n";
+        json << "    \"write_bytes_per_sec\": " << stats->write_bytes_per_sec << "\n";
+    } else if (stats->pids.empty()) {
+        json << "    \"error\": \"No running processes\"\n";
+    } else if (stats->io_errno == EACCES || stats->io_errno == EPERM) {
+        json << "    \"error\": \"Permission denied reading /proc/[pid]/io\"\n";
     } else {
-        json << "    \"error\": \"Unable to read uptime\"\n";
+        json << "    \"error\": \"Unable to read /proc/[pid]/io: " << escape_json(std::strerror(stats->io_errno)) << "\"\n";
     }
     json << "  }\n";
+    json << "}";
+    out = json.str();
+    return true;
+}
+
+std::string get_process_table_json(size_t top_n, ProcessSortKey sort_key) {
+    static std::mutex process_table_mutex;
+    static ProcessTableScanner process_scanner;
+    std::lock_guard<std::mutex> lock(process_table_mutex);
+    
+    std::vector<ProcessEntry> top = process_scanner.scan(top_n, sort_key);
+    long ticks_per_second = sysconf(_SC_CLK_TCK);
     
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(2);
+    json << "{\n";
+    json << "  \"sort\": \"" << (sort_key == ProcessSortKey::Cpu ? "cpu" : "memory") << "\",\n";
+    json << "  \"total_processes\": " << process_scanner.process_count() << ",\n";
+    json << "  \"new_processes\": " << process_scanner.last_new() << ",\n";
+    json << "  \"exited_processes\": " << process_scanner.last_exited() << ",\n";
+    json << "  \"scan_us\": " << process_scanner.last_scan_us() << ",\n";
+    json << "  \"processes\": [\n";
+    for (size_t i = 0; i < top.size(); ++i) {
+        const auto& proc = top[i];
+        json << "    {\"pid\": " << proc.pid;
+        json << ", \"uid\": " << proc.uid;
+        json << ", \"name\": \"" << escape_json(proc.comm) << "\"";
+        json << ", \"state\": \"" << proc.state << "\"";
+        json << ", \"threads\": " << proc.num_threads;
+        json << ", \"cpu_percent\": " << proc.cpu_percent;
+        json << ", \"rss_bytes\": " << proc.rss_bytes;
+        json << ", \"cpu_time_seconds\": " << (double)proc.cpu_time_ticks / ticks_per_second << "}";
+        if (i < top.size() - 1) json << ",";
+        json << "\n";
+    }
+    json << "  ]\n";
     json << "}";
     return json.str();
 }
-
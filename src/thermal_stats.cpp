@@ -0,0 +1,236 @@
+#include "thermal_stats.h"
+#include "proc_reader.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+// Treat a zone as hot this close below its lowest passive trip point
+static const long long kThrottleMarginMillicelsius = 5000;
+
+static void close_all(std::vector<int>& fds) {
+    for (int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+    fds.clear();
+}
+
+// cpufreq cooling ("cpufreq-cpu0", "thermal-cpufreq-0") or ACPI processor
+// throttling ("Processor"); fans and devfreq devices do not cost CPU frequency
+static bool is_cpu_cooling_device(const std::string& type) {
+    std::string lower = type;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    return lower.find("cpufreq") != std::string::npos ||
+           lower.find("processor") != std::string::npos;
+}
+
+// "<kind><N>_input" files of one hwmon device, e.g. temp1_input, fan2_input
+static std::vector<std::string> list_hwmon_inputs(const std::string& dir) {
+    static const char* const kKinds[] = {"temp", "fan", "in", "power"};
+    std::vector<std::string> inputs;
+    for (const auto& name : list_entries(dir)) {
+        size_t suffix = name.find("_input");
+        if (suffix == std::string::npos || suffix + 6 != name.size()) continue;
+        for (const char* kind : kKinds) {
+            size_t len = std::strlen(kind);
+            if (name.compare(0, len, kind) == 0 && suffix > len &&
+                name.find_first_not_of("0123456789", len) == suffix) {
+                inputs.push_back(name);
+                break;
+            }
+        }
+    }
+    return inputs;
+}
+
+ThermalCollector::ThermalCollector(const std::string& sys_root)
+    : cpufreq_collector_(sys_root), collected_once_(false), throttling_(false) {
+    discover(sys_root);
+}
+
+ThermalCollector::~ThermalCollector() {
+    close_all(zone_fds_);
+    close_all(cooling_fds_);
+    close_all(sensor_fds_);
+    for (auto& fds : throttle_fds_) {
+        close_all(fds);
+    }
+}
+
+void ThermalCollector::discover(const std::string& sys_root) {
+    // Thermal zones: type and trip points are static, temp is re-read
+    std::string thermal_dir = sys_root + "/class/thermal";
+    for (const auto& name : list_numbered_entries(thermal_dir, "thermal_zone")) {
+        std::string base = thermal_dir + "/" + name;
+        int fd = open_attribute(base + "/temp");
+        if (fd < 0) continue;
+
+        ThermalZone zone;
+        zone.name = name;
+        zone.type = read_sysfs_string(base + "/type");
+        for (int trip = 0;; ++trip) {
+            std::string prefix = base + "/trip_point_" + std::to_string(trip);
+            std::string temp = read_sysfs_string(prefix + "_temp");
+            if (temp.empty()) break;
+            ThermalTripPoint point;
+            point.type = read_sysfs_string(prefix + "_type");
+            point.temp_millicelsius = std::atoll(temp.c_str());
+            zone.trip_points.push_back(point);
+        }
+        zones_.push_back(zone);
+        zone_fds_.push_back(fd);
+    }
+
+    for (const auto& name : list_numbered_entries(thermal_dir, "cooling_device")) {
+        std::string base = thermal_dir + "/" + name;
+        int fd = open_attribute(base + "/cur_state");
+        if (fd < 0) continue;
+
+        CoolingDevice dev;
+        dev.name = name;
+        dev.type = read_sysfs_string(base + "/type");
+        dev.max_state = std::atoll(read_sysfs_string(base + "/max_state").c_str());
+        cooling_.push_back(dev);
+        cooling_fds_.push_back(fd);
+    }
+
+    // hwmon: every temp/fan/in/power input with its optional label
+    std::string hwmon_dir = sys_root + "/class/hwmon";
+    for (const auto& name : list_numbered_entries(hwmon_dir, "hwmon")) {
+        std::string base = hwmon_dir + "/" + name;
+        std::string chip = read_sysfs_string(base + "/name");
+        if (chip.empty()) chip = name;
+
+        for (const auto& input : list_hwmon_inputs(base)) {
+            int fd = open_attribute(base + "/" + input);
+            if (fd < 0) continue;
+
+            std::string stem = input.substr(0, input.size() - 6);  // Strip "_input"
+            HwmonSensor sensor;
+            sensor.chip = chip;
+            sensor.label = read_sysfs_string(base + "/" + stem + "_label");
+            if (sensor.label.empty()) sensor.label = stem;
+
+            double scale = 1.0;
+            if (stem.compare(0, 4, "temp") == 0) {
+                sensor.kind = "temp";
+                scale = 1e-3;   // millidegree C
+            } else if (stem.compare(0, 3, "fan") == 0) {
+                sensor.kind = "fan";
+            } else if (stem.compare(0, 5, "power") == 0) {
+                sensor.kind = "power";
+                scale = 1e-6;   // microwatt
+            } else {
+                sensor.kind = "in";
+                scale = 1e-3;   // millivolt
+            }
+            sensors_.push_back(sensor);
+            sensor_fds_.push_back(fd);
+            sensor_scale_.push_back(scale);
+        }
+    }
+
+    // x86 hardware throttle counters for each cpufreq policy's CPUs (absent elsewhere)
+    const auto& policies = cpufreq_collector_.policies();
+    throttle_fds_.resize(policies.size());
+    cpufreq_.resize(policies.size());
+    for (size_t i = 0; i < policies.size(); ++i) {
+        for (int cpu : policies[i].cpus) {
+            std::string base = sys_root + "/devices/system/cpu/cpu" + std::to_string(cpu) + "/thermal_throttle/";
+            for (const char* counter : {"core_throttle_count", "package_throttle_count"}) {
+                int fd = open_attribute(base + counter);
+                if (fd >= 0) throttle_fds_[i].push_back(fd);
+            }
+        }
+    }
+}
+
+bool ThermalCollector::collect() {
+    bool any = false;
+
+    for (size_t i = 0; i < zones_.size(); ++i) {
+        zones_[i].ok = read_fd_long_long(zone_fds_[i], zones_[i].temp_millicelsius);
+        any |= zones_[i].ok;
+    }
+    for (size_t i = 0; i < cooling_.size(); ++i) {
+        read_fd_long_long(cooling_fds_[i], cooling_[i].cur_state);
+    }
+    for (size_t i = 0; i < sensors_.size(); ++i) {
+        long long raw = 0;
+        sensors_[i].ok = read_fd_long_long(sensor_fds_[i], raw);
+        sensors_[i].value = raw * sensor_scale_[i];
+        any |= sensors_[i].ok;
+    }
+
+    // cpufreq policies, to tell whether heat is actually costing frequency.
+    // The policy ceiling (scaling_max_freq, lowered by cpufreq cooling) or new
+    // hardware throttle events count; cur_khz alone drops whenever the CPU idles
+    cpufreq_collector_.collect();
+    const auto& policies = cpufreq_collector_.policies();
+    bool any_capped = false;
+    std::string hw_reason;
+    for (size_t i = 0; i < policies.size(); ++i) {
+        CpuFreqLimit& limit = cpufreq_[i];
+        limit.policy = policies[i].name;
+        limit.cur_khz = policies[i].cur_khz;
+        limit.scaling_max_khz = policies[i].scaling_max_khz;
+        limit.cpuinfo_max_khz = policies[i].cpuinfo_max_khz;
+
+        long long throttle_count = 0;
+        bool counted = false;
+        for (int fd : throttle_fds_[i]) {
+            long long value = 0;
+            if (read_fd_long_long(fd, value)) {
+                throttle_count += value;
+                counted = true;
+            }
+        }
+        // First pass only records the baseline
+        bool new_events = counted && collected_once_ && throttle_count > limit.throttle_count;
+        if (new_events && hw_reason.empty()) {
+            hw_reason = limit.policy + " hardware thermal throttle (+" +
+                        std::to_string(throttle_count - limit.throttle_count) + " events)";
+        }
+        if (counted) limit.throttle_count = throttle_count;
+
+        limit.capped = new_events ||
+            (limit.cpuinfo_max_khz > 0 && limit.scaling_max_khz > 0 &&
+             limit.scaling_max_khz < limit.cpuinfo_max_khz);
+        any_capped |= limit.capped;
+    }
+    collected_once_ = true;
+
+    // Hot: a zone within the margin of its first passive trip, or cooling engaged
+    std::string hot_reason;
+    for (const auto& zone : zones_) {
+        if (!zone.ok) continue;
+        for (const auto& trip : zone.trip_points) {
+            if (trip.type == "passive" && zone.temp_millicelsius >= trip.temp_millicelsius - kThrottleMarginMillicelsius) {
+                hot_reason = zone.type + " at " + std::to_string(zone.temp_millicelsius / 1000) +
+                             "C near passive trip " + std::to_string(trip.temp_millicelsius / 1000) + "C";
+                break;
+            }
+        }
+        if (!hot_reason.empty()) break;
+    }
+    if (hot_reason.empty()) {
+        for (const auto& dev : cooling_) {
+            if (dev.cur_state > 0 && is_cpu_cooling_device(dev.type)) {
+                hot_reason = dev.type + " cooling state " + std::to_string(dev.cur_state) +
+                             "/" + std::to_string(dev.max_state);
+                break;
+            }
+        }
+    }
+
+    // The CPU reporting its own thermal throttling needs no zone to confirm it
+    if (hot_reason.empty()) {
+        hot_reason = hw_reason;
+    }
+
+    throttling_ = !hot_reason.empty() && any_capped;
+    throttle_reason_ = throttling_ ? hot_reason : "";
+    return any;
+}
@@ -0,0 +1,163 @@
+#include "topology.h"
+#include "cpufreq_stats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <tuple>
+
+// Attribute as an integer, fallback if missing or empty
+static int read_sysfs_int(const std::string& path, int fallback) {
+    std::string value = read_sysfs_string(path);
+    return value.empty() ? fallback : std::atoi(value.c_str());
+}
+
+// Cache "size" attribute: "32K", "1024K", "8M"
+static long long parse_cache_size(const std::string& text) {
+    char* end = nullptr;
+    long long value = std::strtoll(text.c_str(), &end, 10);
+    if (end == nullptr) return 0;
+    switch (*end) {
+        case 'K': return value * 1024;
+        case 'M': return value * 1024 * 1024;
+        case 'G': return value * 1024 * 1024 * 1024;
+        default: return value;
+    }
+}
+
+CpuTopology read_cpu_topology(const std::string& sys_root) {
+    CpuTopology topology;
+    std::string cpu_dir = sys_root + "/devices/system/cpu";
+    std::vector<int> online = parse_cpu_list(read_sysfs_string(cpu_dir + "/online"));
+
+    std::set<int> packages;
+    // core_id is only unique within a cluster on arm64 (RK3588 numbers its A55 and A76 clusters
+    // from 0 each), so the cluster is part of the key
+    std::set<std::tuple<int, int, int, int>> cores;
+    for (int cpu : online) {
+        std::string base = cpu_dir + "/cpu" + std::to_string(cpu);
+        CpuPlacement placement;
+        placement.cpu = cpu;
+        placement.package = read_sysfs_int(base + "/topology/physical_package_id", -1);
+        placement.die = read_sysfs_int(base + "/topology/die_id", -1);
+        placement.cluster = read_sysfs_int(base + "/topology/cluster_id", -1);
+        placement.core = read_sysfs_int(base + "/topology/core_id", -1);
+        placement.siblings = parse_cpu_list(read_sysfs_string(base + "/topology/thread_siblings_list"));
+        if (placement.siblings.empty()) placement.siblings.push_back(cpu);
+
+        // The same cache instance appears under every CPU sharing it; keep one entry
+        for (const auto& index : list_numbered_entries(base + "/cache", "index")) {
+            std::string cache_base = base + "/cache/" + index;
+            CpuCache cache;
+            cache.level = read_sysfs_int(cache_base + "/level", 0);
+            cache.type = read_sysfs_string(cache_base + "/type");
+            cache.size_bytes = parse_cache_size(read_sysfs_string(cache_base + "/size"));
+            cache.line_bytes = read_sysfs_int(cache_base + "/coherency_line_size", 0);
+            cache.ways = read_sysfs_int(cache_base + "/ways_of_associativity", 0);
+            cache.cpus = parse_cpu_list(read_sysfs_string(cache_base + "/shared_cpu_list"));
+            if (cache.cpus.empty()) cache.cpus.push_back(cpu);
+
+            size_t slot = 0;
+            while (slot < topology.caches.size()) {
+                const CpuCache& known = topology.caches[slot];
+                if (known.level == cache.level && known.type == cache.type && known.cpus == cache.cpus) break;
+                ++slot;
+            }
+            if (slot == topology.caches.size()) {
+                topology.caches.push_back(cache);
+            }
+            placement.caches.push_back((int)slot);
+        }
+
+        packages.insert(placement.package);
+        cores.insert(std::make_tuple(placement.package, placement.die, placement.cluster, placement.core));
+        topology.threads_per_core = std::max(topology.threads_per_core, (int)placement.siblings.size());
+        topology.cpus.push_back(placement);
+    }
+    topology.packages = (int)packages.size();
+    topology.cores = (int)cores.size();
+
+    // "smt/active" exists since Linux 4.19; otherwise infer it from the sibling lists
+    std::string smt = read_sysfs_string(cpu_dir + "/smt/active");
+    topology.smt_active = smt.empty() ? topology.threads_per_core > 1 : smt == "1";
+
+    std::string node_dir = sys_root + "/devices/system/node";
+    for (const auto& name : list_numbered_entries(node_dir, "node")) {
+        std::string base = node_dir + "/" + name;
+        NumaNode node;
+        node.id = std::atoi(name.c_str() + 4);
+        node.cpus = parse_cpu_list(read_sysfs_string(base + "/cpulist"));
+        node.distances = parse_cpu_list(read_sysfs_string(base + "/distance"));
+
+        ProcFileReader meminfo(base + "/meminfo");
+        NumaNodeMemory memory;
+        if (meminfo.read() && parse_node_meminfo(meminfo.data(), memory)) {
+            node.memory_total_bytes = memory.total_bytes;
+        }
+        for (auto& placement : topology.cpus) {
+            if (std::find(node.cpus.begin(), node.cpus.end(), placement.cpu) != node.cpus.end()) {
+                placement.node = node.id;
+            }
+        }
+        topology.nodes.push_back(node);
+    }
+    return topology;
+}
+
+const CpuTopology& get_cpu_topology() {
+    static const CpuTopology topology = read_cpu_topology();
+    return topology;
+}
+
+bool parse_node_meminfo(const char* text, NumaNodeMemory& out) {
+    out.ok = false;
+    const char* p = text;
+    while (*p) {
+        // "Node 0 MemFree:         3354716 kB"
+        const char* eol = std::strchr(p, '\n');
+        const char* colon = std::strchr(p, ':');
+        if (!colon || (eol && colon > eol)) {
+            if (!eol) break;
+            p = eol + 1;
+            continue;
+        }
+        const char* key = colon;
+        while (key > p && key[-1] != ' ') --key;
+        long long value = std::strtoll(colon + 1, nullptr, 10) * 1024;
+        size_t len = colon - key;
+        if (len == 8 && std::strncmp(key, "MemTotal", 8) == 0) {
+            out.total_bytes = value;
+            out.ok = true;
+        } else if (len == 7 && std::strncmp(key, "MemFree", 7) == 0) {
+            out.free_bytes = value;
+        } else if (len == 9 && std::strncmp(key, "FilePages", 9) == 0) {
+            out.file_pages_bytes = value;
+        }
+        if (!eol) break;
+        p = eol + 1;
+    }
+    return out.ok;
+}
+
+NumaMemoryCollector::NumaMemoryCollector(const std::string& sys_root) {
+    std::string node_dir = sys_root + "/devices/system/node";
+    for (const auto& name : list_numbered_entries(node_dir, "node")) {
+        NumaNodeMemory node;
+        node.node = std::atoi(name.c_str() + 4);
+        nodes_.push_back(node);
+        readers_.emplace_back(new ProcFileReader(node_dir + "/" + name + "/meminfo"));
+    }
+}
+
+bool NumaMemoryCollector::collect() {
+    bool any = false;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        ProcFileReader& reader = *readers_[i];
+        if (!reader.read() || !parse_node_meminfo(reader.data(), nodes_[i])) {
+            nodes_[i].ok = false;
+            continue;
+        }
+        any = true;
+    }
+    return any;
+}
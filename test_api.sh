@@ -24,7 +24,7 @@ echo ""
 
 echo "3. Testing POST /v1/core/system/reboot"
 echo "--------------------------------------"
-curl -s -X POST "${BASE_URL}/v1/core/system/reboot" | python3 -m json.tool 2>/dev/null || curl -s -X POST "${BASE_URL}/v1/core/system/reboot"
+curl -s -X POST -u cvedix:cvedix "${BASE_URL}/v1/core/system/reboot" | python3 -m json.tool 2>/dev/null || curl -s -X POST -u cvedix:cvedix "${BASE_URL}/v1/core/system/reboot"
 echo ""
 echo ""
 
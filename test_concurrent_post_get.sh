@@ -0,0 +1,167 @@
+#!/bin/bash
+
+# Concurrency test for device state: POSTs registrations while GETs read them
+# Build the server with ThreadSanitizer and run it from the build directory:
+#   cmake -S . -B build-tsan -DENABLE_TSAN=ON && cmake --build build-tsan
+#   (cd build-tsan && ./metrics_monitor_system 2> tsan.log)
+# Then run this script with the log path, which fails on any
+# "WARNING: ThreadSanitizer" report in it:
+#   ./test_concurrent_post_get.sh 8080 200 4 4 build-tsan/tsan.log
+
+PORT=${1:-8080}
+ROUNDS=${2:-200}
+READERS=${3:-4}
+WRITERS=${4:-4}
+TSAN_LOG=${5:-}
+CONCURRENT_ROUNDS=$((ROUNDS / 4))
+BASE_URL="http://localhost:${PORT}"
+
+echo "=========================================="
+echo "Concurrent POST/GET /v1/core/system/info (${ROUNDS} POSTs, ${CONCURRENT_ROUNDS} rounds of ${WRITERS} concurrent POSTs, ${READERS} readers)"
+echo "=========================================="
+echo ""
+
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "${TMP_DIR}"' EXIT
+
+# Every POST writes a serial number and an instance with the same suffix, so
+# a GET that sees a torn update (one field from each state) is detectable
+post() {
+    curl -s -o /dev/null -w "%{http_code}\n" -X POST "${BASE_URL}/v1/core/system/info" \
+      -u cvedix:cvedix \
+      -H "Content-Type: application/json" \
+      -d "{\"device\": {\"serial_number\": \"SN-$1\"}, \"instances\": [\"instance-$1\"]}"
+}
+
+post_loop() {
+    for i in $(seq 1 "${ROUNDS}"); do
+        post "${i}"
+    done > "${TMP_DIR}/post_codes"
+}
+
+# Serial number of the current state, or "torn"/"invalid"
+current_serial() {
+    curl -s "${BASE_URL}/v1/core/system/info" | python3 -c '
+import json, sys
+try:
+    info = json.load(sys.stdin)
+except ValueError:
+    print("invalid")
+    sys.exit()
+serial = info["device"]["serial_number"]
+print(serial if info["instances"] == ["instance-" + serial[3:]] else "torn")
+'
+}
+
+# Rounds of concurrent POSTs, each writer updating only its own device field.
+# Once a round is acknowledged every field must hold that round's value: a
+# reload of a file the server wrote itself must never drop an update that was
+# published but not yet saved
+FIELDS=(model_type device_type hardware_revision production_date warranty_period build_date mode version)
+[ "${WRITERS}" -gt "${#FIELDS[@]}" ] && WRITERS=${#FIELDS[@]}
+
+post_field() {
+    curl -s -o /dev/null -w "%{http_code}\n" -X POST "${BASE_URL}/v1/core/system/info" \
+      -u cvedix:cvedix \
+      -H "Content-Type: application/json" \
+      -d "{\"device\": {\"$1\": \"$2\"}}"
+}
+
+concurrent_post_rounds() {
+    for r in $(seq 1 "${CONCURRENT_ROUNDS}"); do
+        pids=""
+        for w in $(seq 1 "${WRITERS}"); do
+            # Staggered so that some POSTs land while an earlier one is being written
+            (sleep "0.0$(( (w - 1) * 15 % 100 ))"; post_field "${FIELDS[$((w - 1))]}" "r${r}") > "${TMP_DIR}/cpost_${w}" &
+            pids="${pids} $!"
+        done
+        wait ${pids}
+        cat "${TMP_DIR}"/cpost_* >> "${TMP_DIR}/concurrent_post_codes"
+        curl -s "${BASE_URL}/v1/core/system/info" | python3 -c '
+import json, sys
+expected, fields = sys.argv[1], sys.argv[2:]
+try:
+    device = json.load(sys.stdin)["device"]
+except ValueError:
+    print("invalid")
+    sys.exit()
+stale = [f + "=" + device[f] for f in fields if device[f] != expected]
+print("round " + expected + " lost " + ",".join(stale) if stale else "ok")
+' "r${r}" "${FIELDS[@]:0:${WRITERS}}"
+    done > "${TMP_DIR}/concurrent_rounds"
+}
+
+get_loop() {
+    local reader=$1
+    while [ ! -f "${TMP_DIR}/done" ]; do
+        curl -s "${BASE_URL}/v1/core/system/info" | python3 -c '
+import json, sys
+try:
+    info = json.load(sys.stdin)
+except ValueError:
+    print("invalid")
+    sys.exit()
+serial = info["device"]["serial_number"]
+instances = info["instances"]
+if serial.startswith("SN-") and instances != ["instance-" + serial[3:]]:
+    print("torn " + serial + " " + ",".join(instances))
+else:
+    print("ok")
+'
+    done > "${TMP_DIR}/get_${reader}"
+}
+
+READER_PIDS=""
+for r in $(seq 1 "${READERS}"); do
+    get_loop "$r" &
+    READER_PIDS="${READER_PIDS} $!"
+done
+post_loop
+concurrent_post_rounds
+
+# The last acknowledged POST must still be the state after the watcher has seen its write
+post final > "${TMP_DIR}/final_code"
+sleep 1
+FINAL_SERIAL=$(current_serial)
+touch "${TMP_DIR}/done"
+wait ${READER_PIDS}
+
+POST_OK=$(grep -c '^200$' "${TMP_DIR}/post_codes")
+CONCURRENT_EXPECTED=$((CONCURRENT_ROUNDS * WRITERS))
+CONCURRENT_OK=$(grep -c '^200$' "${TMP_DIR}/concurrent_post_codes")
+ROUNDS_BAD=$(grep -vc '^ok$' "${TMP_DIR}/concurrent_rounds")
+FINAL_OK=$(grep -c '^200$' "${TMP_DIR}/final_code")
+GET_OK=$(cat "${TMP_DIR}"/get_* | grep -c '^ok$')
+GET_BAD=$(cat "${TMP_DIR}"/get_* | grep -vc '^ok$')
+
+echo "POST 200 responses: ${POST_OK}/${ROUNDS}"
+echo "Concurrent POST 200 responses: ${CONCURRENT_OK}/${CONCURRENT_EXPECTED}"
+echo "Rounds that lost an acknowledged update: ${ROUNDS_BAD}/${CONCURRENT_ROUNDS}"
+grep -v '^ok$' "${TMP_DIR}/concurrent_rounds" | head -5
+echo "State after the last acknowledged POST: ${FINAL_SERIAL} (expected SN-final)"
+echo "Consistent GET responses: ${GET_OK}"
+echo "Invalid or torn GET responses: ${GET_BAD}"
+cat "${TMP_DIR}"/get_* | grep -v '^ok$' | sort | uniq -c | head -10
+TSAN_REPORTS=0
+if [ -n "${TSAN_LOG}" ]; then
+    if [ -f "${TSAN_LOG}" ]; then
+        TSAN_REPORTS=$(grep -c 'WARNING: ThreadSanitizer' "${TSAN_LOG}")
+        echo "ThreadSanitizer reports in ${TSAN_LOG}: ${TSAN_REPORTS}"
+        grep -A 3 'WARNING: ThreadSanitizer' "${TSAN_LOG}" | head -20
+    else
+        echo "ThreadSanitizer log ${TSAN_LOG} not found"
+        TSAN_REPORTS=1
+    fi
+else
+    echo "No ThreadSanitizer log given (5th argument); check the server's stderr for reports"
+fi
+echo ""
+
+if [ "${POST_OK}" -eq "${ROUNDS}" ] && [ "${GET_BAD}" -eq 0 ] &&
+   [ "${CONCURRENT_OK}" -eq "${CONCURRENT_EXPECTED}" ] && [ "${ROUNDS_BAD}" -eq 0 ] &&
+   [ "${FINAL_OK}" -eq 1 ] && [ "${FINAL_SERIAL}" = "SN-final" ] && [ "${TSAN_REPORTS}" -eq 0 ]; then
+    echo "✓ PASS"
+else
+    echo "✗ FAIL"
+    exit 1
+fi
@@ -11,7 +11,7 @@ sleep 2
 
 # Test case 1: Valid request
 echo "Sending valid request..."
-curl -v -X POST http://localhost:8080/v1/core/firmware/command \
+curl -v -X POST -u cvedix:cvedix http://localhost:8080/v1/core/firmware/command \
      -H "Content-Type: application/json" \
      -d '{"action": "update", "url": "http://example.com/firmware.deb"}'
 
@@ -19,7 +19,7 @@ echo -e "\n\n"
 
 # Test case 2: Invalid action
 echo "Sending invalid action..."
-curl -v -X POST http://localhost:8080/v1/core/firmware/command \
+curl -v -X POST -u cvedix:cvedix http://localhost:8080/v1/core/firmware/command \
      -H "Content-Type: application/json" \
      -d '{"action": "delete", "url": "http://example.com/firmware.deb"}'
 
@@ -27,12 +27,20 @@ echo -e "\n\n"
 
 # Test case 3: Missing URL
 echo "Sending missing URL..."
-curl -v -X POST http://localhost:8080/v1/core/firmware/command \
+curl -v -X POST -u cvedix:cvedix http://localhost:8080/v1/core/firmware/command \
      -H "Content-Type: application/json" \
      -d '{"action": "update"}'
 
 echo -e "\n\n"
 
+# Test case 4: Missing credentials (expect 401)
+echo "Sending request without credentials..."
+curl -v -X POST http://localhost:8080/v1/core/firmware/command \
+     -H "Content-Type: application/json" \
+     -d '{"action": "update", "url": "http://example.com/firmware.deb"}'
+
+echo -e "\n\n"
+
 # Kill server
 kill $SERVER_PID
 echo "Server stopped."
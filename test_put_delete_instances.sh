@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Test script for incremental instance registration (PUT/DELETE /v1/core/instances/{id})
+
+PORT=${1:-8080}
+BASE_URL="http://localhost:${PORT}"
+INSTANCE="test-instance-$$"
+
+echo "=========================================="
+echo "Testing PUT/DELETE /v1/core/instances/{id}"
+echo "=========================================="
+echo ""
+
+list_instances() {
+    curl -s "${BASE_URL}/v1/core/system/info" | python3 -c 'import json, sys; print(" ".join(json.load(sys.stdin)["instances"]))'
+}
+
+FAILED=0
+expect() {
+    local name=$1 expected=$2 actual=$3
+    if [ "${expected}" = "${actual}" ]; then
+        echo "✓ ${name}: ${actual}"
+    else
+        echo "✗ ${name}: expected ${expected}, got ${actual}"
+        FAILED=1
+    fi
+}
+
+request() {
+    curl -s -o /dev/null -w "%{http_code}" -X "$1" -u "${2:-cvedix:cvedix}" -H "Content-Length: 0" \
+      "${BASE_URL}/v1/core/instances/$3"
+}
+
+echo "Instances before: $(list_instances)"
+echo ""
+
+expect "PUT without credentials" 401 "$(request PUT wrong:wrong "${INSTANCE}")"
+expect "PUT new instance" 201 "$(request PUT cvedix:cvedix "${INSTANCE}")"
+expect "PUT existing instance" 200 "$(request PUT cvedix:cvedix "${INSTANCE}")"
+
+LAST=$(list_instances | awk '{print $NF}')
+expect "New instance listed last" "${INSTANCE}" "${LAST}"
+
+if [ -f "./device_instances.journal" ]; then
+    echo "Journal tail: $(tail -n 1 ./device_instances.journal)"
+fi
+
+expect "DELETE instance" 200 "$(request DELETE cvedix:cvedix "${INSTANCE}")"
+expect "DELETE missing instance" 404 "$(request DELETE cvedix:cvedix "${INSTANCE}")"
+
+if list_instances | grep -qw -- "${INSTANCE}"; then
+    echo "✗ Instance still listed after DELETE"
+    FAILED=1
+else
+    echo "✓ Instance no longer listed"
+fi
+
+echo ""
+echo "Instances after: $(list_instances)"
+echo ""
+if [ "${FAILED}" -eq 0 ]; then
+    echo "✓ PASS"
+else
+    echo "✗ FAIL"
+    exit 1
+fi
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Test script for the StatsD push exporter
+# Starts a local UDP listener that stands in for the StatsD agent.
+# Run the server with "statsd": {"enabled": true, "port": <PORT>} in config.json.
+
+PORT=${1:-8125}
+DURATION=${2:-15}
+
+echo "=========================================="
+echo "Listening for StatsD datagrams on 127.0.0.1:${PORT} (${DURATION}s)"
+echo "=========================================="
+echo ""
+
+python3 - "$PORT" "$DURATION" <<'PYEOF'
+import socket
+import sys
+import time
+
+port = int(sys.argv[1])
+duration = float(sys.argv[2])
+
+sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+sock.bind(("127.0.0.1", port))
+sock.settimeout(1.0)
+
+deadline = time.time() + duration
+datagrams = 0
+lines = 0
+max_size = 0
+while time.time() < deadline:
+    try:
+        data = sock.recv(65535)
+    except socket.timeout:
+        continue
+    datagrams += 1
+    max_size = max(max_size, len(data))
+    for line in data.decode().splitlines():
+        lines += 1
+        print("  " + line)
+    print("  -- datagram %d: %d bytes" % (datagrams, len(data)))
+
+print("")
+print("Received %d datagrams, %d metric lines, largest %d bytes" % (datagrams, lines, max_size))
+if datagrams == 0:
+    print("✗ No datagrams received - is the exporter enabled?")
+    sys.exit(1)
+if max_size > 1432:
+    print("✗ Datagram larger than default max_packet_bytes (1432)")
+    sys.exit(1)
+print("✓ StatsD exporter is pushing metrics")
+PYEOF
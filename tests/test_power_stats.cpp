@@ -0,0 +1,121 @@
+// PowerCollector and energy_delta_uj against the sysfs fixture in tests/fixtures/power
+// Usage: test_power_stats <fixture_root>
+// The fixture is copied to a scratch directory and edited between passes;
+// passes use synthetic timestamps so RAPL watts are exact
+
+#include "power_stats.h"
+#include "test_util.h"
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <fixture_root>\n";
+        return 2;
+    }
+    char scratch[] = "/tmp/test_power_XXXXXX";
+    if (mkdtemp(scratch) == nullptr) {
+        std::cerr << "mkdtemp failed\n";
+        return 2;
+    }
+    g_root = scratch;
+    fs::copy(argv[1], g_root, fs::copy_options::recursive);
+
+    // Wraparound: the counter runs from previous up to max_range, then 0 to current
+    CHECK(energy_delta_uj(10, 30, 100) == 20);
+    CHECK(energy_delta_uj(30, 30, 100) == 0);
+    CHECK(energy_delta_uj(90, 10, 100) == 20);
+    CHECK(energy_delta_uj(262143000000LL, 671150, 262143328850LL) == 1000000);
+    CHECK(energy_delta_uj(90, 10, 0) == 0);     // Unknown range: no rate rather than a huge one
+
+    {
+        PowerCollector collector(g_root.string());
+        auto t0 = std::chrono::steady_clock::now();
+        CHECK(collector.collect(t0));
+
+        // powercap: control-type dir (no max_energy_range_uj) is skipped
+        const auto& domains = collector.domains();
+        CHECK(domains.size() == 3);
+        if (domains.size() == 3) {
+            CHECK(domains[0].zone == "intel-rapl:0");
+            CHECK(domains[0].name == "package-0");
+            CHECK(domains[0].max_energy_range_uj == 262143328850LL);
+            CHECK(domains[0].energy_uj == 262143000000LL);
+            CHECK(domains[0].ok);
+            CHECK(domains[0].watts == -1);  // No rate from a single reading
+            CHECK(domains[1].name == "core");
+            CHECK(domains[2].name == "package-1");
+        }
+        CHECK(collector.package_watts() == -1);
+
+        // package-0 wraps (+1 J), core +2 J, package-1 +0.5 J over 0.5 s
+        set_attr("class/powercap/intel-rapl:0/energy_uj", "671150");
+        set_attr("class/powercap/intel-rapl:0:0/energy_uj", "3000000");
+        set_attr("class/powercap/intel-rapl:1/energy_uj", "5500000");
+        collector.collect(t0 + std::chrono::milliseconds(500));
+        if (domains.size() == 3) {
+            CHECK(domains[0].energy_uj == 671150);
+            CHECK(near(domains[0].watts, 2.0));
+            CHECK(near(domains[1].watts, 4.0));
+            CHECK(near(domains[2].watts, 1.0));
+        }
+        // Package domains only; core is already inside package-0
+        CHECK(near(collector.package_watts(), 3.0));
+
+        // power_supply: mains online, battery from voltage * |current|, battery from power_now
+        const auto& supplies = collector.supplies();
+        CHECK(supplies.size() == 3);
+        if (supplies.size() == 3) {
+            CHECK(supplies[0].name == "AC");
+            CHECK(supplies[0].type == "Mains");
+            CHECK(supplies[0].online == 1);
+            CHECK(supplies[0].watts == -1);
+            CHECK(supplies[1].name == "BAT0");
+            CHECK(supplies[1].type == "Battery");
+            CHECK(supplies[1].status == "Discharging");
+            CHECK(supplies[1].capacity_percent == 87);
+            CHECK(near(supplies[1].watts, 18.0));
+            CHECK(supplies[2].status == "Charging");
+            CHECK(near(supplies[2].watts, 9.5));
+        }
+
+        // hwmon: INA3221 channels from in<N> * curr<N> (in4 is a shunt voltage
+        // without a current and is skipped); INA226 from power1_input only
+        const auto& sensors = collector.sensors();
+        CHECK(sensors.size() == 4);
+        if (sensors.size() == 4) {
+            CHECK(sensors[0].chip == "ina3221");
+            CHECK(sensors[0].label == "VDD_IN");
+            CHECK(sensors[0].ok);
+            CHECK(near(sensors[0].watts, 2.0));
+            CHECK(sensors[1].label == "VDD_CPU");
+            CHECK(near(sensors[1].watts, 0.25));
+            CHECK(sensors[2].label == "channel3");
+            CHECK(near(sensors[2].watts, 0.0));
+            CHECK(sensors[3].chip == "ina226");
+            CHECK(sensors[3].label == "power1");
+            CHECK(near(sensors[3].watts, 2.5));
+        }
+
+        // Discharging battery reported with a positive current on other drivers
+        set_attr("class/power_supply/BAT0/current_now", "1500000");
+        set_attr("class/power_supply/BAT0/status", "Full");
+        collector.collect(t0 + std::chrono::milliseconds(1500));
+        if (supplies.size() == 3) {
+            CHECK(supplies[1].status == "Full");
+            CHECK(near(supplies[1].watts, 18.0));
+        }
+        // Counters unchanged over 1 s: zero power, not a wrap
+        if (domains.size() == 3) {
+            CHECK(near(domains[0].watts, 0.0));
+        }
+    }
+
+    fs::remove_all(g_root);
+    if (g_failures > 0) {
+        std::cerr << g_failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "test_power_stats: all checks passed\n";
+    return 0;
+}
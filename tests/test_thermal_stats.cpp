@@ -0,0 +1,165 @@
+// ThermalCollector against the sysfs fixture in tests/fixtures/thermal
+// Usage: test_thermal_stats <fixture_root>
+// The fixture is copied to a scratch directory and edited between passes,
+// the same way sysfs attributes change under the collector's open fds
+
+#include "thermal_stats.h"
+#include "test_util.h"
+#include <cstdlib>
+#include <string>
+
+static bool starts_with(const std::string& s, const std::string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <fixture_root>\n";
+        return 2;
+    }
+    char scratch[] = "/tmp/test_thermal_XXXXXX";
+    if (mkdtemp(scratch) == nullptr) {
+        std::cerr << "mkdtemp failed\n";
+        return 2;
+    }
+    g_root = scratch;
+    fs::copy(argv[1], g_root, fs::copy_options::recursive);
+
+    const std::string policy0 = "devices/system/cpu/cpufreq/policy0/scaling_max_freq";
+    const std::string zone0 = "class/thermal/thermal_zone0/temp";
+    const std::string processor = "class/thermal/cooling_device0/cur_state";
+    const std::string cpufreq_cooling = "class/thermal/cooling_device1/cur_state";
+    const std::string core_throttle = "devices/system/cpu/cpu1/thermal_throttle/core_throttle_count";
+
+    {
+        ThermalCollector collector(g_root.string());
+        CHECK(collector.collect());
+
+        // Zones, temperatures and trip points
+        const auto& zones = collector.zones();
+        CHECK(zones.size() == 2);
+        if (zones.size() == 2) {
+            CHECK(zones[0].name == "thermal_zone0");
+            CHECK(zones[0].type == "x86_pkg_temp");
+            CHECK(zones[0].ok);
+            CHECK(zones[0].temp_millicelsius == 72000);
+            CHECK(zones[0].trip_points.size() == 2);
+            if (zones[0].trip_points.size() == 2) {
+                CHECK(zones[0].trip_points[0].type == "passive");
+                CHECK(zones[0].trip_points[0].temp_millicelsius == 75000);
+                CHECK(zones[0].trip_points[1].type == "critical");
+                CHECK(zones[0].trip_points[1].temp_millicelsius == 100000);
+            }
+            CHECK(zones[1].type == "acpitz");
+            CHECK(zones[1].temp_millicelsius == 40000);
+            CHECK(zones[1].trip_points.size() == 1);
+        }
+
+        const auto& cooling = collector.cooling_devices();
+        CHECK(cooling.size() == 3);
+        if (cooling.size() == 3) {
+            CHECK(cooling[0].type == "Processor");
+            CHECK(cooling[0].max_state == 10);
+            CHECK(cooling[1].type == "thermal-cpufreq-0");
+            CHECK(cooling[2].type == "Fan");
+            CHECK(cooling[2].cur_state == 1);
+        }
+
+        // hwmon: temp in C, fan in RPM, in* in V; labels fall back to the input name
+        const auto& sensors = collector.sensors();
+        CHECK(sensors.size() == 4);
+        if (sensors.size() == 4) {
+            CHECK(sensors[0].chip == "coretemp");
+            CHECK(sensors[0].label == "Package id 0");
+            CHECK(sensors[0].kind == "temp");
+            CHECK(near(sensors[0].value, 72.0));
+            CHECK(sensors[1].label == "temp2");
+            CHECK(near(sensors[1].value, 65.0));
+            CHECK(sensors[2].chip == "nct6775");
+            CHECK(sensors[2].kind == "fan");
+            CHECK(near(sensors[2].value, 1200.0));
+            CHECK(sensors[3].label == "Vcore");
+            CHECK(sensors[3].kind == "in");
+            CHECK(near(sensors[3].value, 1.05));
+        }
+
+        // Hot (72C, passive trip at 75C) but the governor idling at 800 MHz is
+        // not a frequency cap: scaling_max_freq is still the hardware maximum
+        const auto& limits = collector.cpufreq_limits();
+        CHECK(limits.size() == 2);
+        if (limits.size() == 2) {
+            CHECK(limits[0].policy == "policy0");
+            CHECK(limits[0].cur_khz == 800000);
+            CHECK(limits[0].cpuinfo_max_khz == 3600000);
+            CHECK(!limits[0].capped);
+            CHECK(!limits[1].capped);
+        }
+        CHECK(!collector.throttling());
+        CHECK(collector.throttle_reason().empty());
+
+        // Hot and capped by scaling_max_freq
+        set_attr(policy0, "2400000");
+        collector.collect();
+        CHECK(collector.cpufreq_limits()[0].capped);
+        CHECK(!collector.cpufreq_limits()[1].capped);
+        CHECK(collector.throttling());
+        CHECK(starts_with(collector.throttle_reason(), "x86_pkg_temp at 72C near passive trip 75C"));
+
+        // Capped but cool: a user-imposed limit is not thermal throttling
+        set_attr(zone0, "50000");
+        collector.collect();
+        CHECK(!collector.throttling());
+
+        // ACPI processor cooling device engaged while capped
+        set_attr(processor, "3");
+        collector.collect();
+        CHECK(collector.throttling());
+        CHECK(collector.throttle_reason() == "Processor cooling state 3/10");
+
+        // thermal-cpufreq-N style naming is a CPU cooling device too
+        set_attr(processor, "0");
+        set_attr(cpufreq_cooling, "2");
+        collector.collect();
+        CHECK(collector.throttling());
+        CHECK(collector.throttle_reason() == "thermal-cpufreq-0 cooling state 2/5");
+
+        // Cooling engaged but the ceiling restored: not throttling
+        set_attr(policy0, "3600000");
+        collector.collect();
+        CHECK(!collector.throttling());
+
+        // An active fan does not cost CPU frequency
+        set_attr(cpufreq_cooling, "0");
+        set_attr(policy0, "2400000");
+        collector.collect();
+        CHECK(!collector.throttling());
+        set_attr(policy0, "3600000");
+
+        // x86 hardware throttle events on cpu1 cap policy0 for that pass only
+        set_attr(core_throttle, "5");
+        collector.collect();
+        CHECK(collector.cpufreq_limits()[0].capped);
+        CHECK(collector.cpufreq_limits()[0].throttle_count == 5);
+        CHECK(!collector.cpufreq_limits()[1].capped);
+        CHECK(collector.throttling());
+        CHECK(collector.throttle_reason() == "policy0 hardware thermal throttle (+5 events)");
+        collector.collect();
+        CHECK(!collector.cpufreq_limits()[0].capped);
+        CHECK(!collector.throttling());
+    }
+
+    // Counters already non-zero at startup are a baseline, not new events
+    {
+        ThermalCollector collector(g_root.string());
+        collector.collect();
+        CHECK(!collector.throttling());
+    }
+
+    fs::remove_all(g_root);
+    if (g_failures > 0) {
+        std::cerr << g_failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "test_thermal_stats: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+// Shared helpers for the collector tests; each test is a single translation unit
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #cond << "\n";  \
+            g_failures++;                                                    \
+        }                                                                    \
+    } while (0)
+
+// Scratch copy of the fixture the collector under test reads
+static fs::path g_root;
+
+// Rewrite in place (same inode) so the collector's kept-open fd sees it
+static void set_attr(const std::string& rel, const std::string& value) {
+    std::ofstream file(g_root / rel, std::ios::trunc);
+    file << value << "\n";
+}
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) < 1e-9;
+}
+
+#endif // TEST_UTIL_H